@@ -41,6 +41,29 @@ input_getc (void)
   return key;
 }
 
+/* Retrieves up to SIZE keys from the input buffer into BUF.
+   If the buffer is empty, waits for a key to be pressed, then
+   takes whatever else is already buffered, stopping early after
+   a new-line.  Returns the number of keys retrieved. */
+size_t
+input_getbuf (uint8_t *buf, size_t size) 
+{
+  enum intr_level old_level;
+  size_t cnt = 0;
+
+  if (size == 0)
+    return 0;
+
+  old_level = intr_disable ();
+  do
+    buf[cnt] = intq_getc (&buffer);
+  while (buf[cnt++] != '\n' && cnt < size && !intq_empty (&buffer));
+  serial_notify ();
+  intr_set_level (old_level);
+  
+  return cnt;
+}
+
 /* Returns true if the input buffer is full,
    false otherwise.
    Interrupts must be off. */
@@ -129,6 +129,47 @@ serial_putc (uint8_t byte)
   intr_set_level (old_level);
 }
 
+/* Sends the N bytes in BUFFER to the serial port.
+   Like calling serial_putc() on each byte, but disables
+   interrupts once and updates the interrupt enable register
+   only when the transmit queue fills up or at the end, instead
+   of once per byte. */
+void
+serial_putbuf (const uint8_t *buffer, size_t n) 
+{
+  enum intr_level old_level = intr_disable ();
+
+  if (mode != QUEUE)
+    {
+      if (mode == UNINIT)
+        init_poll ();
+      while (n-- > 0)
+        putc_poll (*buffer++);
+    }
+  else
+    while (n > 0)
+      {
+        /* Queue as much as fits, then start the transmitter. */
+        while (n > 0 && !intq_full (&txq))
+          {
+            intq_putc (&txq, *buffer++);
+            n--;
+          }
+        write_ier ();
+
+        /* Make room for the rest, the same way as serial_putc(). */
+        if (n > 0 && old_level == INTR_OFF)
+          putc_poll (intq_getc (&txq));
+        else if (n > 0)
+          {
+            intq_putc (&txq, *buffer++);
+            n--;
+          }
+      }
+
+  intr_set_level (old_level);
+}
+
 /* Flushes anything in the serial buffer out the port in polling
    mode. */
 void
@@ -11,7 +11,13 @@
 #endif
 #ifdef FILESYS
 #include "devices/block.h"
+#include "filesys/cache.h"
 #include "filesys/filesys.h"
+#ifdef VM
+#include "vm/frame.h"
+#include "vm/ksm.h"
+#include "vm/swap.h"
+#endif
 #endif
 
 /* Keyboard control register port. */
@@ -124,10 +130,16 @@ print_stats (void)
   thread_print_stats ();
 #ifdef FILESYS
   block_print_stats ();
+  cache_print_stats ();
 #endif
   console_print_stats ();
   kbd_print_stats ();
 #ifdef USERPROG
   exception_print_stats ();
 #endif
+#ifdef VM
+  frame_print_stats ();
+  swap_print_stats ();
+  ksm_print_stats ();
+#endif
 }
@@ -3,8 +3,12 @@
 #include <string.h>
 #include <syscall.h>
 
+/* Maximum number of commands in a pipeline. */
+#define MAX_STAGES 8
+
 static void read_line (char line[], size_t);
 static bool backspace (char **pos, char line[]);
+static void run_pipeline (char *pipeline);
 
 int
 main (void)
@@ -30,6 +34,8 @@ main (void)
         {
           /* Empty command. */
         }
+      else if (strchr (command, '|') != NULL)
+        run_pipeline (command);
       else
         {
           pid_t pid = exec (command);
@@ -44,6 +50,78 @@ main (void)
   return EXIT_SUCCESS;
 }
 
+/* Runs each `|'-separated command in PIPELINE, connecting the
+   standard output of each to the standard input of the next
+   with a pipe, then waits for all of them.
+
+   Children inherit our stdin and stdout at exec() time, so we
+   point those at the pipe ends around each exec() and close them
+   again afterward, which puts them back on the console. */
+static void
+run_pipeline (char *pipeline) 
+{
+  pid_t pids[MAX_STAGES];
+  char *commands[MAX_STAGES];
+  char *command, *save_ptr;
+  int stage_cnt = 0;
+  int in_fd = -1;
+  int i;
+
+  for (command = strtok_r (pipeline, "|", &save_ptr); command != NULL;
+       command = strtok_r (NULL, "|", &save_ptr))
+    {
+      if (stage_cnt >= MAX_STAGES)
+        {
+          printf ("too many commands in pipeline\n");
+          return;
+        }
+      commands[stage_cnt++] = command;
+    }
+
+  for (i = 0; i < stage_cnt; i++)
+    {
+      bool last = i == stage_cnt - 1;
+      int fds[2];
+
+      if (!last && !pipe (fds))
+        {
+          printf ("pipe failed\n");
+          last = true;
+        }
+
+      /* Wire up this command's stdin and stdout. */
+      if (in_fd >= 0)
+        {
+          dup2 (in_fd, STDIN_FILENO);
+          close (in_fd);
+          in_fd = -1;
+        }
+      if (!last)
+        {
+          dup2 (fds[1], STDOUT_FILENO);
+          close (fds[1]);
+          in_fd = fds[0];
+        }
+
+      pids[i] = exec (commands[i]);
+      close (STDIN_FILENO);
+      close (STDOUT_FILENO);
+      if (pids[i] == PID_ERROR)
+        printf ("\"%s\": exec failed\n", commands[i]);
+      if (last)
+        {
+          stage_cnt = i + 1;
+          break;
+        }
+    }
+  if (in_fd >= 0)
+    close (in_fd);
+
+  for (i = 0; i < stage_cnt; i++)
+    if (pids[i] != PID_ERROR)
+      printf ("\"%s\": exit code %d\n", commands[i], wait (pids[i]));
+}
+
 /* Reads a line of input from the user into LINE, which has room
    for SIZE bytes.  Handles backspace and Ctrl+U in the ways
    expected by Unix users.  On return, LINE will always be
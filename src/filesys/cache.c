@@ -0,0 +1,375 @@
+#include "filesys/cache.h"
+#include <debug.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "filesys/filesys.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+/* Buffer cache.
+
+   Keeps recently used sectors of the file system device in
+   memory, so that reading or writing part of a sector does not
+   cost a whole transfer to or from the disk.  Writes only update
+   the cached copy and mark it dirty.  A dirty sector reaches the
+   disk when its entry is evicted or cache_flush() is called.
+   Entries are evicted in clock order.
+
+   Two kernel threads work in the background.  The read-ahead
+   thread loads the sectors queued by cache_prefetch(), which
+   file_read() calls when it sees a file read sequentially.  The
+   write-behind thread flushes dirty sectors every
+   WRITE_BEHIND_SECS seconds, so that little is lost if the
+   machine stops without filesys_done().
+
+   cache_lock protects which sector each entry holds and the
+   clock bookkeeping.  Each entry's own lock protects its data,
+   so that I/O on one sector does not hold up the others.  An
+   entry in use by some thread is never evicted. */
+
+/* No sector. */
+#define CACHE_NONE ((block_sector_t) -1)
+
+/* Most sectors waiting for the read-ahead thread.  Further
+   requests are dropped. */
+#define PREFETCH_MAX 64
+
+/* Seconds between flushes by the write-behind thread. */
+#define WRITE_BEHIND_SECS 5
+
+/* A cache entry. */
+struct cache_entry
+  {
+    /* Protected by cache_lock. */
+    block_sector_t sector;              /* Sector held, or CACHE_NONE. */
+    block_sector_t evicting;            /* Old sector being written out. */
+    int users;                          /* Threads using the entry. */
+    bool accessed;                      /* Used since the hand went by? */
+
+    /* Protected by LOCK, or by cache_lock while USERS is 0. */
+    struct lock lock;
+    bool valid;                         /* DATA holds SECTOR's contents? */
+    bool dirty;                         /* DATA newer than the disk? */
+    uint8_t data[BLOCK_SECTOR_SIZE];    /* Sector contents. */
+  };
+
+/* Number of sectors in the cache. */
+unsigned cache_sectors = CACHE_SECTORS_DEFAULT;
+
+static struct cache_entry *entries;
+static size_t clock_hand;
+static struct lock cache_lock;
+
+/* Broadcast when an entry falls out of use or finishes writing
+   out its old sector. */
+static struct condition cache_changed;
+
+/* Sectors waiting for the read-ahead thread, a ring of
+   PREFETCH_MAX starting at prefetch_head, and its lock. */
+static block_sector_t prefetch_queue[PREFETCH_MAX];
+static size_t prefetch_head, prefetch_cnt;
+static struct lock prefetch_lock;
+static struct condition prefetch_ready;
+
+/* Statistics. */
+static unsigned long long hit_cnt, miss_cnt, write_cnt, prefetch_load_cnt;
+
+static struct cache_entry *cache_get (block_sector_t);
+static void cache_put (struct cache_entry *);
+static struct cache_entry *lookup (block_sector_t);
+static bool is_evicting (block_sector_t);
+static struct cache_entry *choose_victim (void);
+static void read_ahead_daemon (void *);
+static void write_behind_daemon (void *);
+
+/* Initializes the buffer cache and starts its threads. */
+void
+cache_init (void)
+{
+  size_t i;
+
+  if (cache_sectors == 0)
+    PANIC ("buffer cache must hold at least one sector");
+  entries = calloc (cache_sectors, sizeof *entries);
+  if (entries == NULL)
+    PANIC ("could not allocate %u-sector buffer cache", cache_sectors);
+
+  lock_init (&cache_lock);
+  cond_init (&cache_changed);
+  for (i = 0; i < cache_sectors; i++)
+    {
+      entries[i].sector = CACHE_NONE;
+      entries[i].evicting = CACHE_NONE;
+      lock_init (&entries[i].lock);
+    }
+
+  lock_init (&prefetch_lock);
+  cond_init (&prefetch_ready);
+  thread_create ("read-ahead", PRI_DEFAULT, read_ahead_daemon, NULL);
+  thread_create ("write-behind", PRI_DEFAULT, write_behind_daemon, NULL);
+}
+
+/* Reads SIZE bytes starting at byte offset OFS within SECTOR of
+   the file system device into BUFFER. */
+void
+cache_read (block_sector_t sector, void *buffer, int ofs, int size)
+{
+  struct cache_entry *e;
+
+  ASSERT (ofs >= 0 && size >= 0 && ofs + size <= BLOCK_SECTOR_SIZE);
+
+  e = cache_get (sector);
+  if (e->valid)
+    hit_cnt++;
+  else
+    {
+      miss_cnt++;
+      block_read (fs_device, sector, e->data);
+      e->valid = true;
+    }
+  memcpy (buffer, e->data + ofs, size);
+  cache_put (e);
+}
+
+/* Writes SIZE bytes from BUFFER into SECTOR of the file system
+   device, starting at byte offset OFS within the sector. */
+void
+cache_write (block_sector_t sector, const void *buffer, int ofs, int size)
+{
+  struct cache_entry *e;
+
+  ASSERT (ofs >= 0 && size >= 0 && ofs + size <= BLOCK_SECTOR_SIZE);
+
+  e = cache_get (sector);
+  if (e->valid || size == BLOCK_SECTOR_SIZE)
+    hit_cnt++;
+  else
+    {
+      miss_cnt++;
+      block_read (fs_device, sector, e->data);
+    }
+  memcpy (e->data + ofs, buffer, size);
+  e->valid = true;
+  e->dirty = true;
+  cache_put (e);
+}
+
+/* Asks the read-ahead thread to bring SECTOR into the cache.
+   Returns without waiting. */
+void
+cache_prefetch (block_sector_t sector)
+{
+  lock_acquire (&prefetch_lock);
+  if (prefetch_cnt < PREFETCH_MAX)
+    {
+      size_t tail = (prefetch_head + prefetch_cnt++) % PREFETCH_MAX;
+      prefetch_queue[tail] = sector;
+      cond_signal (&prefetch_ready, &prefetch_lock);
+    }
+  lock_release (&prefetch_lock);
+}
+
+/* Writes every dirty sector in the cache to disk. */
+void
+cache_flush (void)
+{
+  size_t i;
+
+  for (i = 0; i < cache_sectors; i++)
+    {
+      struct cache_entry *e = &entries[i];
+
+      lock_acquire (&cache_lock);
+      if (e->sector == CACHE_NONE)
+        {
+          lock_release (&cache_lock);
+          continue;
+        }
+      e->users++;
+      lock_release (&cache_lock);
+
+      lock_acquire (&e->lock);
+      if (e->dirty)
+        {
+          block_write (fs_device, e->sector, e->data);
+          e->dirty = false;
+          write_cnt++;
+        }
+      cache_put (e);
+    }
+}
+
+/* Prints buffer cache statistics. */
+void
+cache_print_stats (void)
+{
+  printf ("Cache: %llu hits, %llu misses, %llu writes, "
+          "%llu sectors read ahead\n",
+          hit_cnt, miss_cnt, write_cnt, prefetch_load_cnt);
+}
+
+/* Returns the entry for SECTOR, taking it over from another
+   sector if SECTOR is not cached, with its lock held.  Its data
+   is SECTOR's only if its VALID member is true.  The caller
+   must release it with cache_put(). */
+static struct cache_entry *
+cache_get (block_sector_t sector)
+{
+  struct cache_entry *e;
+
+  lock_acquire (&cache_lock);
+  for (;;)
+    {
+      e = lookup (sector);
+      if (e != NULL)
+        {
+          e->users++;
+          e->accessed = true;
+          lock_release (&cache_lock);
+          lock_acquire (&e->lock);
+          return e;
+        }
+
+      /* If SECTOR's old contents are still on their way to disk,
+         wait for them, or we would read stale data. */
+      if (!is_evicting (sector))
+        {
+          e = choose_victim ();
+          if (e != NULL)
+            break;
+        }
+      cond_wait (&cache_changed, &cache_lock);
+    }
+
+  /* Take over E.  Nobody else is using it, so its lock is free
+     and acquiring it does not block. */
+  lock_acquire (&e->lock);
+  if (e->dirty)
+    e->evicting = e->sector;
+  e->sector = sector;
+  e->users++;
+  e->accessed = true;
+  e->valid = false;
+  lock_release (&cache_lock);
+
+  if (e->evicting != CACHE_NONE)
+    {
+      block_write (fs_device, e->evicting, e->data);
+      write_cnt++;
+
+      lock_acquire (&cache_lock);
+      e->evicting = CACHE_NONE;
+      e->dirty = false;
+      cond_broadcast (&cache_changed, &cache_lock);
+      lock_release (&cache_lock);
+    }
+  return e;
+}
+
+/* Releases E, obtained from cache_get(). */
+static void
+cache_put (struct cache_entry *e)
+{
+  lock_release (&e->lock);
+
+  lock_acquire (&cache_lock);
+  if (--e->users == 0)
+    cond_broadcast (&cache_changed, &cache_lock);
+  lock_release (&cache_lock);
+}
+
+/* Returns the entry holding SECTOR, or a null pointer if there
+   is none. */
+static struct cache_entry *
+lookup (block_sector_t sector)
+{
+  size_t i;
+
+  ASSERT (lock_held_by_current_thread (&cache_lock));
+
+  for (i = 0; i < cache_sectors; i++)
+    if (entries[i].sector == sector)
+      return &entries[i];
+  return NULL;
+}
+
+/* Returns true if SECTOR's dirty data is being written out by
+   an entry that has been taken over by another sector. */
+static bool
+is_evicting (block_sector_t sector)
+{
+  size_t i;
+
+  ASSERT (lock_held_by_current_thread (&cache_lock));
+
+  for (i = 0; i < cache_sectors; i++)
+    if (entries[i].evicting == sector)
+      return true;
+  return false;
+}
+
+/* Chooses an entry to evict with the clock algorithm and
+   returns it, or a null pointer if every entry is in use. */
+static struct cache_entry *
+choose_victim (void)
+{
+  size_t i;
+
+  ASSERT (lock_held_by_current_thread (&cache_lock));
+
+  for (i = 0; i < 2 * cache_sectors; i++)
+    {
+      struct cache_entry *e = &entries[clock_hand];
+
+      clock_hand = (clock_hand + 1) % cache_sectors;
+      if (e->users > 0)
+        continue;
+      if (!e->accessed)
+        return e;
+      e->accessed = false;
+    }
+  return NULL;
+}
+
+/* Loads the sectors queued by cache_prefetch(). */
+static void
+read_ahead_daemon (void *aux UNUSED)
+{
+  for (;;)
+    {
+      struct cache_entry *e;
+      block_sector_t sector;
+
+      lock_acquire (&prefetch_lock);
+      while (prefetch_cnt == 0)
+        cond_wait (&prefetch_ready, &prefetch_lock);
+      sector = prefetch_queue[prefetch_head];
+      prefetch_head = (prefetch_head + 1) % PREFETCH_MAX;
+      prefetch_cnt--;
+      lock_release (&prefetch_lock);
+
+      e = cache_get (sector);
+      if (!e->valid)
+        {
+          block_read (fs_device, sector, e->data);
+          e->valid = true;
+          prefetch_load_cnt++;
+        }
+      cache_put (e);
+    }
+}
+
+/* Periodically writes dirty sectors to disk. */
+static void
+write_behind_daemon (void *aux UNUSED)
+{
+  for (;;)
+    {
+      timer_sleep (WRITE_BEHIND_SECS * TIMER_FREQ);
+      cache_flush ();
+    }
+}
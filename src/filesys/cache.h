@@ -0,0 +1,20 @@
+#ifndef FILESYS_CACHE_H
+#define FILESYS_CACHE_H
+
+#include "devices/block.h"
+
+/* Default number of sectors in the buffer cache. */
+#define CACHE_SECTORS_DEFAULT 64
+
+/* Number of sectors in the buffer cache.  Set with the -cache
+   kernel command line option. */
+extern unsigned cache_sectors;
+
+void cache_init (void);
+void cache_read (block_sector_t, void *, int ofs, int size);
+void cache_write (block_sector_t, const void *, int ofs, int size);
+void cache_prefetch (block_sector_t);
+void cache_flush (void);
+void cache_print_stats (void);
+
+#endif /* filesys/cache.h */
@@ -1,5 +1,6 @@
 #include "filesys/file.h"
 #include <debug.h>
+#include "devices/block.h"
 #include "filesys/inode.h"
 #include "threads/malloc.h"
 
@@ -9,8 +10,20 @@ struct file
     struct inode *inode;        /* File's inode. */
     off_t pos;                  /* Current position. */
     bool deny_write;            /* Has file_deny_write() been called? */
+
+    /* Read-ahead stream window. */
+    off_t ra_next;              /* Where a sequential read would start. */
+    off_t ra_end;               /* End of the data read ahead so far. */
+    off_t ra_size;              /* Window size, 0 if not sequential. */
   };
 
+/* Read-ahead window sizes.  The window starts at RA_MIN and
+   doubles with each sequential read up to RA_MAX. */
+#define RA_MIN (4 * BLOCK_SECTOR_SIZE)
+#define RA_MAX (32 * BLOCK_SECTOR_SIZE)
+
+static void read_ahead (struct file *, bool sequential);
+
 /* Opens a file for the given INODE, of which it takes ownership,
    and returns the new file.  Returns a null pointer if an
    allocation fails or if INODE is null. */
@@ -64,12 +77,16 @@ file_get_inode (struct file *file)
    starting at the file's current position.
    Returns the number of bytes actually read,
    which may be less than SIZE if end of file is reached.
-   Advances FILE's position by the number of bytes read. */
+   Advances FILE's position by the number of bytes read.
+   If FILE is being read sequentially, starts reading the data
+   that follows in the background. */
 off_t
 file_read (struct file *file, void *buffer, off_t size) 
 {
+  bool sequential = file->pos == file->ra_next;
   off_t bytes_read = inode_read_at (file->inode, buffer, size, file->pos);
   file->pos += bytes_read;
+  read_ahead (file, sequential);
   return bytes_read;
 }
 
@@ -166,3 +183,35 @@ file_tell (struct file *file)
   ASSERT (file != NULL);
   return file->pos;
 }
+
+/* Updates FILE's read-ahead window after a read that ended at
+   its current position, and prefetches whatever part of the
+   window has not been yet.  A read that did not continue from
+   where the last one ended closes the window. */
+static void
+read_ahead (struct file *file, bool sequential)
+{
+  off_t end;
+
+  file->ra_next = file->pos;
+  if (!sequential)
+    {
+      file->ra_size = 0;
+      file->ra_end = file->pos;
+      return;
+    }
+
+  if (file->ra_size == 0)
+    file->ra_size = RA_MIN;
+  else if (file->ra_size < RA_MAX)
+    file->ra_size *= 2;
+
+  if (file->ra_end < file->pos)
+    file->ra_end = file->pos;
+  end = file->pos + file->ra_size;
+  if (end > file->ra_end)
+    {
+      inode_prefetch (file->inode, end - file->ra_end, file->ra_end);
+      file->ra_end = end;
+    }
+}
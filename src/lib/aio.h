@@ -0,0 +1,12 @@
+#ifndef __LIB_AIO_H
+#define __LIB_AIO_H
+
+/* Completion of an asynchronous read or write, as reported to a
+   user process by aio_wait(). */
+struct aio_event
+  {
+    int id;                     /* Returned by aio_read()/aio_write(). */
+    int res;                    /* Bytes transferred, or -1. */
+  };
+
+#endif /* lib/aio.h */
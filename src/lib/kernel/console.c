@@ -148,13 +148,19 @@ puts (const char *s)
   return 0;
 }
 
-/* Writes the N characters in BUFFER to the console. */
+/* Writes the N characters in BUFFER to the console.
+   The whole buffer is handed to the serial port at once, rather
+   than character by character as putchar_have_lock() does. */
 void
 putbuf (const char *buffer, size_t n) 
 {
+  size_t i;
+
   acquire_console ();
-  while (n-- > 0)
-    putchar_have_lock (*buffer++);
+  write_cnt += n;
+  serial_putbuf ((const uint8_t *) buffer, n);
+  for (i = 0; i < n; i++)
+    vga_putc (buffer[i]);
   release_console ();
 }
 
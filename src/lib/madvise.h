@@ -0,0 +1,12 @@
+#ifndef __LIB_MADVISE_H
+#define __LIB_MADVISE_H
+
+/* Advice to madvise() about how a process will use a range of
+   its pages. */
+#define MADV_NORMAL 0           /* No special treatment. */
+#define MADV_RANDOM 1           /* Random access: no read-ahead. */
+#define MADV_SEQUENTIAL 2       /* Read once, in order. */
+#define MADV_WILLNEED 3         /* Will be needed soon: load now. */
+#define MADV_DONTNEED 4         /* Not needed: discard contents. */
+
+#endif /* lib/madvise.h */
@@ -0,0 +1,27 @@
+#ifndef __LIB_SHARED_DATA_H
+#define __LIB_SHARED_DATA_H
+
+#include <stdint.h>
+
+/* Read-only page that the kernel maps into every user process
+   at SHARED_DATA_ADDR, just below the executable's load
+   address, so that the current time and process id can be read
+   without a system call.
+
+   The kernel rewrites the clock fields on every timer tick,
+   bumping `seq' to an odd value before and back to an even
+   value after, so a reader that sees the same even `seq' before
+   and after reading has a consistent snapshot.  `pid' is a
+   single word, rewritten whenever a process is switched in. */
+#define SHARED_DATA_ADDR ((void *) 0x08047000)
+
+struct shared_data
+  {
+    uint32_t seq;               /* Update sequence count. */
+    int pid;                    /* Id of the running process. */
+    int64_t ticks;              /* Timer ticks since boot. */
+    int64_t time_ns;            /* Nanoseconds since boot. */
+    uint32_t boot_time;         /* Seconds since the epoch at boot. */
+  };
+
+#endif /* lib/shared-data.h */
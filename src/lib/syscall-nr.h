@@ -28,7 +28,19 @@ enum
     SYS_MKDIR,                  /* Create a directory. */
     SYS_READDIR,                /* Reads a directory entry. */
     SYS_ISDIR,                  /* Tests if a fd represents a directory. */
-    SYS_INUMBER                 /* Returns the inode number for a fd. */
+    SYS_INUMBER,                /* Returns the inode number for a fd. */
+
+    /* Extensions. */
+    SYS_RING_SETUP,             /* Register a batched syscall ring. */
+    SYS_RING_ENTER,             /* Run queued ring requests. */
+    SYS_AIO_READ,               /* Queue an asynchronous read. */
+    SYS_AIO_WRITE,              /* Queue an asynchronous write. */
+    SYS_AIO_WAIT,               /* Collect asynchronous completions. */
+    SYS_PIPE,                   /* Create a pipe. */
+    SYS_DUP2,                   /* Duplicate a file descriptor. */
+    SYS_WAIT_ANY,               /* Wait for any child process to die. */
+    SYS_EXEC_RSS,               /* Start a process with an RSS limit. */
+    SYS_MADVISE                 /* Advise on use of a range of memory. */
   };
 
 #endif /* lib/syscall-nr.h */
@@ -0,0 +1,68 @@
+#ifndef __LIB_SYSCALL_RING_H
+#define __LIB_SYSCALL_RING_H
+
+#include <stdint.h>
+
+/* Batched system call ring, shared between a user process and
+   the kernel.
+
+   The process allocates a `struct syscall_ring' in its own
+   memory and registers it once with ring_setup().  It then
+   queues requests by filling in sq[sq_tail % RING_ENTRIES] and
+   incrementing sq_tail, and submits the whole batch with a
+   single ring_enter() call.  The kernel consumes requests by
+   advancing sq_head and posts one completion per request at
+   cq[cq_tail % RING_ENTRIES], advancing cq_tail.  The process
+   reaps completions by advancing cq_head.
+
+   Each head and tail is written by one side only, so no locking
+   is needed.  Indexes run freely and wrap around at UINT32_MAX;
+   RING_ENTRIES must therefore be a power of two. */
+
+/* Number of entries in each queue. */
+#define RING_ENTRIES 64
+
+/* Request opcodes. */
+enum ring_op
+  {
+    RING_NOP,                   /* Do nothing, complete with 0. */
+    RING_OPEN,                  /* open (buf). */
+    RING_CLOSE,                 /* close (fd). */
+    RING_READ,                  /* read (fd, buf, len). */
+    RING_WRITE,                 /* write (fd, buf, len). */
+    RING_PREAD,                 /* Read LEN bytes at offset OFS. */
+    RING_PWRITE,                /* Write LEN bytes at offset OFS. */
+    RING_SEEK,                  /* seek (fd, ofs). */
+    RING_FILESIZE               /* filesize (fd). */
+  };
+
+/* Submission queue entry. */
+struct ring_sqe
+  {
+    uint32_t op;                /* One of enum ring_op. */
+    int fd;                     /* File descriptor. */
+    void *buf;                  /* Buffer, or file name for RING_OPEN. */
+    uint32_t len;               /* Buffer size in bytes. */
+    uint32_t ofs;               /* File offset for PREAD/PWRITE/SEEK. */
+    uint32_t user_data;         /* Copied into the completion. */
+  };
+
+/* Completion queue entry. */
+struct ring_cqe
+  {
+    uint32_t user_data;         /* From the submission. */
+    int res;                    /* What the equivalent syscall returns. */
+  };
+
+/* A submission queue and its completion queue. */
+struct syscall_ring
+  {
+    uint32_t sq_head;           /* Next request to consume (kernel). */
+    uint32_t sq_tail;           /* Next free request slot (user). */
+    uint32_t cq_head;           /* Next completion to reap (user). */
+    uint32_t cq_tail;           /* Next free completion slot (kernel). */
+    struct ring_sqe sq[RING_ENTRIES];
+    struct ring_cqe cq[RING_ENTRIES];
+  };
+
+#endif /* lib/syscall-ring.h */
@@ -0,0 +1,56 @@
+#include <shared-data.h>
+#include <syscall.h>
+
+/* The kernel's read-only shared data page. */
+static volatile const struct shared_data *const shared_data
+  = SHARED_DATA_ADDR;
+
+/* Optimization barrier, as in threads/synch.h. */
+#define barrier() asm volatile ("" : : : "memory")
+
+/* Returns the number of timer ticks since the OS booted.
+   Reads the shared data page instead of trapping. */
+int64_t
+getticks (void) 
+{
+  uint32_t seq;
+  int64_t ticks;
+
+  do 
+    {
+      seq = shared_data->seq;
+      barrier ();
+      ticks = shared_data->ticks;
+      barrier ();
+    }
+  while ((seq & 1) != 0 || seq != shared_data->seq);
+  return ticks;
+}
+
+/* Returns the number of nanoseconds since the OS booted, at
+   timer tick resolution.  Reads the shared data page instead of
+   trapping. */
+int64_t
+gettime (void) 
+{
+  uint32_t seq;
+  int64_t time_ns;
+
+  do 
+    {
+      seq = shared_data->seq;
+      barrier ();
+      time_ns = shared_data->time_ns;
+      barrier ();
+    }
+  while ((seq & 1) != 0 || seq != shared_data->seq);
+  return time_ns;
+}
+
+/* Returns the id of the calling process.  Reads the shared data
+   page instead of trapping. */
+pid_t
+getpid (void) 
+{
+  return shared_data->pid;
+}
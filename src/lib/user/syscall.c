@@ -61,6 +61,25 @@
           retval;                                               \
         })
 
+/* Invokes syscall NUMBER, passing arguments ARG0, ARG1, ARG2,
+   and ARG3, and returns the return value as an `int'. */
+#define syscall4(NUMBER, ARG0, ARG1, ARG2, ARG3)                \
+        ({                                                      \
+          int retval;                                           \
+          asm volatile                                          \
+            ("pushl %[arg3]; pushl %[arg2]; pushl %[arg1]; "    \
+             "pushl %[arg0]; pushl %[number]; int $0x30; "      \
+             "addl $20, %%esp"                                  \
+               : "=a" (retval)                                  \
+               : [number] "i" (NUMBER),                         \
+                 [arg0] "g" (ARG0),                             \
+                 [arg1] "g" (ARG1),                             \
+                 [arg2] "g" (ARG2),                             \
+                 [arg3] "g" (ARG3)                              \
+               : "memory");                                     \
+          retval;                                               \
+        })
+
 void
 halt (void) 
 {
@@ -182,3 +201,63 @@ inumber (int fd)
 {
   return syscall1 (SYS_INUMBER, fd);
 }
+
+bool
+ring_setup (struct syscall_ring *ring)
+{
+  return syscall1 (SYS_RING_SETUP, ring);
+}
+
+int
+ring_enter (unsigned to_submit)
+{
+  return syscall1 (SYS_RING_ENTER, to_submit);
+}
+
+int
+aio_read (int fd, void *buffer, unsigned size, unsigned offset)
+{
+  return syscall4 (SYS_AIO_READ, fd, buffer, size, offset);
+}
+
+int
+aio_write (int fd, const void *buffer, unsigned size, unsigned offset)
+{
+  return syscall4 (SYS_AIO_WRITE, fd, buffer, size, offset);
+}
+
+int
+aio_wait (struct aio_event *events, unsigned max)
+{
+  return syscall2 (SYS_AIO_WAIT, events, max);
+}
+
+bool
+pipe (int fds[2])
+{
+  return syscall1 (SYS_PIPE, fds);
+}
+
+int
+dup2 (int old_fd, int new_fd)
+{
+  return syscall2 (SYS_DUP2, old_fd, new_fd);
+}
+
+pid_t
+wait_any (int *status)
+{
+  return syscall1 (SYS_WAIT_ANY, status);
+}
+
+pid_t
+exec_rss (const char *file, unsigned max_pages)
+{
+  return (pid_t) syscall2 (SYS_EXEC_RSS, file, max_pages);
+}
+
+int
+madvise (void *addr, unsigned length, int advice)
+{
+  return syscall3 (SYS_MADVISE, addr, length, advice);
+}
@@ -2,7 +2,11 @@
 #define __LIB_USER_SYSCALL_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <debug.h>
+#include <syscall-ring.h>
+#include <aio.h>
+#include <madvise.h>
 
 /* Process identifier. */
 typedef int pid_t;
@@ -47,4 +51,22 @@ bool readdir (int fd, char name[READDIR_MAX_LEN + 1]);
 bool isdir (int fd);
 int inumber (int fd);
 
+/* Extensions. */
+bool ring_setup (struct syscall_ring *);
+int ring_enter (unsigned to_submit);
+int aio_read (int fd, void *buffer, unsigned length, unsigned offset);
+int aio_write (int fd, const void *buffer, unsigned length, unsigned offset);
+int aio_wait (struct aio_event *events, unsigned max);
+bool pipe (int fds[2]);
+int dup2 (int old_fd, int new_fd);
+pid_t wait_any (int *status);
+pid_t exec_rss (const char *file, unsigned max_pages);
+int madvise (void *addr, unsigned length, int advice);
+
+/* Extensions that read the kernel's shared data page
+   (lib/shared-data.h) instead of trapping. */
+int64_t getticks (void);
+int64_t gettime (void);
+pid_t getpid (void);
+
 #endif /* lib/user/syscall.h */
@@ -0,0 +1,25 @@
+/* Passes aio_read() and aio_write() a bad fd, a kernel buffer
+   and an unmapped buffer, each of which must return -1 without
+   killing the process. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char buf[64];
+
+void
+test_main (void) 
+{
+  int handle;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (aio_read (0x20101234, buf, sizeof buf, 0) == -1,
+         "aio_read with bad fd");
+  CHECK (aio_write (0x20101234, buf, sizeof buf, 0) == -1,
+         "aio_write with bad fd");
+  CHECK (aio_read (handle, (char *) 0xc0000000, sizeof buf, 0) == -1,
+         "aio_read into kernel memory");
+  CHECK (aio_write (handle, (char *) 0x20101234, sizeof buf, 0) == -1,
+         "aio_write from unmapped memory");
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(aio-bad) begin
+(aio-bad) open "sample.txt"
+(aio-bad) aio_read with bad fd
+(aio-bad) aio_write with bad fd
+(aio-bad) aio_read into kernel memory
+(aio-bad) aio_write from unmapped memory
+(aio-bad) end
+aio-bad: exit(0)
+EOF
+pass;
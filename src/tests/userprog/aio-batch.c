@@ -0,0 +1,76 @@
+/* Queues several asynchronous writes, then several reads, and
+   collects each set of completions with as few aio_wait() calls
+   as they come in, checking that every request completes exactly
+   once with the right result. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define CHUNK_CNT 8
+#define CHUNK_SIZE 512
+
+static char data[CHUNK_CNT * CHUNK_SIZE];
+static char buf[CHUNK_CNT * CHUNK_SIZE];
+
+/* Collects the completions of the CHUNK_CNT requests in IDS. */
+static void
+collect (const int ids[CHUNK_CNT])
+{
+  bool done[CHUNK_CNT];
+  int left = CHUNK_CNT;
+
+  memset (done, 0, sizeof done);
+  while (left > 0)
+    {
+      struct aio_event ev[CHUNK_CNT];
+      int cnt = aio_wait (ev, CHUNK_CNT);
+      int i, j;
+
+      if (cnt < 1 || cnt > left)
+        fail ("aio_wait returned %d with %d requests in flight", cnt, left);
+      for (i = 0; i < cnt; i++)
+        {
+          for (j = 0; j < CHUNK_CNT; j++)
+            if (ids[j] == ev[i].id)
+              break;
+          if (j == CHUNK_CNT || done[j])
+            fail ("unexpected completion for request %d", ev[i].id);
+          if (ev[i].res != CHUNK_SIZE)
+            fail ("request %d transferred %d bytes", ev[i].id, ev[i].res);
+          done[j] = true;
+        }
+      left -= cnt;
+    }
+}
+
+void
+test_main (void) 
+{
+  int ids[CHUNK_CNT];
+  int handle, i;
+
+  for (i = 0; i < CHUNK_CNT * CHUNK_SIZE; i++)
+    data[i] = i % 251;
+  CHECK (create ("batch.txt", sizeof data), "create \"batch.txt\"");
+  CHECK ((handle = open ("batch.txt")) > 1, "open \"batch.txt\"");
+
+  msg ("queue %d writes", CHUNK_CNT);
+  for (i = 0; i < CHUNK_CNT; i++)
+    if ((ids[i] = aio_write (handle, data + i * CHUNK_SIZE, CHUNK_SIZE,
+                             i * CHUNK_SIZE)) < 0)
+      fail ("aio_write of chunk %d failed", i);
+  collect (ids);
+  msg ("writes completed");
+
+  msg ("queue %d reads", CHUNK_CNT);
+  for (i = 0; i < CHUNK_CNT; i++)
+    if ((ids[i] = aio_read (handle, buf + i * CHUNK_SIZE, CHUNK_SIZE,
+                            i * CHUNK_SIZE)) < 0)
+      fail ("aio_read of chunk %d failed", i);
+  collect (ids);
+  if (memcmp (buf, data, sizeof data))
+    fail ("data read back differs from data written");
+  msg ("reads completed");
+}
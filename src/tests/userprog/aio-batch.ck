@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(aio-batch) begin
+(aio-batch) create "batch.txt"
+(aio-batch) open "batch.txt"
+(aio-batch) queue 8 writes
+(aio-batch) writes completed
+(aio-batch) queue 8 reads
+(aio-batch) reads completed
+(aio-batch) end
+aio-batch: exit(0)
+EOF
+pass;
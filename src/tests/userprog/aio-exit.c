@@ -0,0 +1,22 @@
+/* Runs a child that queues asynchronous writes and exits without
+   waiting for them.  The child's exit must wait for the writes,
+   which must all reach the file. */
+
+#include <syscall.h>
+#include "tests/userprog/aio-exit.h"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char data[AIO_EXIT_SIZE];
+
+void
+test_main (void) 
+{
+  int i;
+
+  for (i = 0; i < AIO_EXIT_SIZE; i++)
+    data[i] = 'a' + i % 26;
+  CHECK (create ("aio-exit.txt", sizeof data), "create \"aio-exit.txt\"");
+  CHECK (wait (exec ("child-aio")) == 0, "wait for child-aio");
+  check_file ("aio-exit.txt", data, sizeof data);
+}
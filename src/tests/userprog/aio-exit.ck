@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(aio-exit) begin
+(aio-exit) create "aio-exit.txt"
+(child-aio) open "aio-exit.txt"
+(child-aio) exit with writes in flight
+child-aio: exit(0)
+(aio-exit) wait for child-aio
+(aio-exit) open "aio-exit.txt" for verification
+(aio-exit) verified contents of "aio-exit.txt"
+(aio-exit) close "aio-exit.txt"
+(aio-exit) end
+aio-exit: exit(0)
+EOF
+pass;
@@ -0,0 +1,7 @@
+#ifndef TESTS_USERPROG_AIO_EXIT_H
+#define TESTS_USERPROG_AIO_EXIT_H
+
+/* Size of the file child-aio writes for aio-exit. */
+#define AIO_EXIT_SIZE 4096
+
+#endif /* tests/userprog/aio-exit.h */
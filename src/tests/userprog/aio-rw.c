@@ -0,0 +1,50 @@
+/* Writes a file with aio_write(), waits for the write to
+   complete, then reads it back with aio_read() and checks both
+   completions and the data. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char buf[sizeof sample];
+
+/* Waits for the single request ID to complete and checks that
+   it transferred SIZE bytes. */
+static void
+wait_one (int id, int size)
+{
+  struct aio_event ev;
+  int cnt = aio_wait (&ev, 1);
+
+  if (cnt != 1)
+    fail ("aio_wait returned %d, expected 1", cnt);
+  if (ev.id != id || ev.res != size)
+    fail ("completion (%d, %d), expected (%d, %d)", ev.id, ev.res, id, size);
+}
+
+void
+test_main (void) 
+{
+  struct aio_event ev;
+  int handle, id;
+
+  CHECK (create ("aio.txt", sizeof sample - 1), "create \"aio.txt\"");
+  CHECK ((handle = open ("aio.txt")) > 1, "open \"aio.txt\"");
+
+  CHECK ((id = aio_write (handle, sample, sizeof sample - 1, 0)) >= 0,
+         "aio_write");
+  wait_one (id, sizeof sample - 1);
+  msg ("write completed");
+
+  CHECK ((id = aio_read (handle, buf, sizeof sample - 1, 0)) >= 0,
+         "aio_read");
+  wait_one (id, sizeof sample - 1);
+  if (memcmp (buf, sample, sizeof sample - 1))
+    fail ("data read back differs from data written");
+  msg ("read completed");
+
+  CHECK (aio_wait (&ev, 1) == 0, "aio_wait with nothing pending");
+  check_file ("aio.txt", sample, sizeof sample - 1);
+}
@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(aio-rw) begin
+(aio-rw) create "aio.txt"
+(aio-rw) open "aio.txt"
+(aio-rw) aio_write
+(aio-rw) write completed
+(aio-rw) aio_read
+(aio-rw) read completed
+(aio-rw) aio_wait with nothing pending
+(aio-rw) open "aio.txt" for verification
+(aio-rw) verified contents of "aio.txt"
+(aio-rw) close "aio.txt"
+(aio-rw) end
+aio-rw: exit(0)
+EOF
+pass;
@@ -0,0 +1,29 @@
+/* Child process run by aio-exit test.
+
+   Queues asynchronous writes that fill "aio-exit.txt" and exits
+   without calling aio_wait(). */
+
+#include <syscall.h>
+#include "tests/userprog/aio-exit.h"
+#include "tests/lib.h"
+
+const char *test_name = "child-aio";
+
+#define CHUNK_SIZE 512
+
+static char data[AIO_EXIT_SIZE];
+
+int
+main (void) 
+{
+  int handle, i;
+
+  for (i = 0; i < AIO_EXIT_SIZE; i++)
+    data[i] = 'a' + i % 26;
+  CHECK ((handle = open ("aio-exit.txt")) > 1, "open \"aio-exit.txt\"");
+  for (i = 0; i < AIO_EXIT_SIZE; i += CHUNK_SIZE)
+    if (aio_write (handle, data + i, CHUNK_SIZE, i) < 0)
+      fail ("aio_write at offset %d failed", i);
+  msg ("exit with writes in flight");
+  return 0;
+}
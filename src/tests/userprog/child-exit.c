@@ -0,0 +1,13 @@
+/* Child process run by wait-any and wait-any-bad-ptr tests.
+   Exits with the code given as its argument, printing nothing,
+   so that its parent's output doesn't depend on when it runs. */
+
+#include <stdlib.h>
+
+const char *test_name = "child-exit";
+
+int
+main (int argc, char *argv[]) 
+{
+  return argc > 1 ? atoi (argv[1]) : 0;
+}
@@ -0,0 +1,22 @@
+/* Child process run by shared-data test.
+
+   Writes the process id that getpid() returns to
+   "child-pid.txt", which its parent has created. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+
+const char *test_name = "child-getpid";
+
+int
+main (void) 
+{
+  pid_t pid = getpid ();
+  int handle;
+
+  CHECK ((handle = open ("child-pid.txt")) > 1, "open \"child-pid.txt\"");
+  if (write (handle, &pid, sizeof pid) != sizeof pid)
+    fail ("write to \"child-pid.txt\" failed");
+  close (handle);
+  return 0;
+}
@@ -0,0 +1,37 @@
+/* Child process run by pipe-pipeline test.
+
+   Reads its stdin, which its parent has redirected to a pipe,
+   until end of file and checks that it received the data
+   child-pipe-write sends. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/userprog/pipe-data.h"
+#include "tests/lib.h"
+
+const char *test_name = "child-pipe-read";
+
+int
+main (void) 
+{
+  char buf[1000];
+  int total = 0;
+  int cnt;
+
+  while ((cnt = read (STDIN_FILENO, buf, sizeof buf)) > 0)
+    {
+      int i;
+
+      for (i = 0; i < cnt; i++)
+        if (total + i >= PIPE_DATA_SIZE
+            || buf[i] != pipe_data_byte (total + i))
+          fail ("bad byte at offset %d", total + i);
+      total += cnt;
+    }
+  if (cnt < 0)
+    fail ("read returned %d", cnt);
+  if (total != PIPE_DATA_SIZE)
+    fail ("read %d bytes, expected %d", total, PIPE_DATA_SIZE);
+  msg ("read %d bytes", total);
+  return 0;
+}
@@ -0,0 +1,22 @@
+/* Child process run by pipe-rw and pipe-pipeline tests.
+
+   Writes PIPE_DATA_SIZE bytes to its stdout, which its parent
+   has redirected to a pipe, in a single write().  Since stdout
+   is the pipe, it cannot report errors with msg(), so it exits
+   with code 1 if the write comes up short. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/userprog/pipe-data.h"
+
+static char data[PIPE_DATA_SIZE];
+
+int
+main (void) 
+{
+  int i;
+
+  for (i = 0; i < PIPE_DATA_SIZE; i++)
+    data[i] = pipe_data_byte (i);
+  return write (STDOUT_FILENO, data, PIPE_DATA_SIZE) == PIPE_DATA_SIZE ? 0 : 1;
+}
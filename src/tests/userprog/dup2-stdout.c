@@ -0,0 +1,32 @@
+/* Redirects stdout to a file with dup2(), writes through it,
+   then closes stdout again, which puts it back on the console,
+   and checks that the data landed in the file. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  int handle, res;
+
+  CHECK (create ("out.txt", 0), "create \"out.txt\"");
+  CHECK ((handle = open ("out.txt")) > 1, "open \"out.txt\"");
+
+  /* Nothing else may be written to stdout while it is
+     redirected. */
+  if (dup2 (handle, STDOUT_FILENO) != STDOUT_FILENO)
+    fail ("dup2 onto stdout failed");
+  res = write (STDOUT_FILENO, sample, sizeof sample - 1);
+  close (STDOUT_FILENO);
+  msg ("stdout back on console");
+  if (res != sizeof sample - 1)
+    fail ("write to redirected stdout returned %d, expected %zu",
+          res, sizeof sample - 1);
+
+  close (handle);
+  check_file ("out.txt", sample, sizeof sample - 1);
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(dup2-stdout) begin
+(dup2-stdout) create "out.txt"
+(dup2-stdout) open "out.txt"
+(dup2-stdout) stdout back on console
+(dup2-stdout) open "out.txt" for verification
+(dup2-stdout) verified contents of "out.txt"
+(dup2-stdout) close "out.txt"
+(dup2-stdout) end
+dup2-stdout: exit(0)
+EOF
+pass;
@@ -0,0 +1,27 @@
+/* Uses pipe ends the wrong way round and passes bad fds to
+   dup2().  Each call must fail with -1 without killing the
+   process. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char buf[16];
+  int fds[2];
+
+  CHECK (pipe (fds), "pipe");
+  CHECK (read (fds[1], buf, sizeof buf) == -1, "read from write end");
+  CHECK (write (fds[0], "x", 1) == -1, "write to read end");
+  CHECK (dup2 (0x20101234, STDOUT_FILENO) == -1, "dup2 from bad fd");
+  CHECK (dup2 (fds[0], 0x20101234) == -1, "dup2 onto bad fd");
+  CHECK (dup2 (fds[0], -1) == -1, "dup2 onto negative fd");
+
+  msg ("close read end");
+  close (fds[0]);
+  CHECK (write (fds[1], "x", 1) == -1, "write with no read end");
+  CHECK (write (fds[0], "x", 1) == -1, "write to closed fd");
+}
@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pipe-bad-fd) begin
+(pipe-bad-fd) pipe
+(pipe-bad-fd) read from write end
+(pipe-bad-fd) write to read end
+(pipe-bad-fd) dup2 from bad fd
+(pipe-bad-fd) dup2 onto bad fd
+(pipe-bad-fd) dup2 onto negative fd
+(pipe-bad-fd) close read end
+(pipe-bad-fd) write with no read end
+(pipe-bad-fd) write to closed fd
+(pipe-bad-fd) end
+pipe-bad-fd: exit(0)
+EOF
+pass;
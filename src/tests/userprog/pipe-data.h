@@ -0,0 +1,16 @@
+#ifndef TESTS_USERPROG_PIPE_DATA_H
+#define TESTS_USERPROG_PIPE_DATA_H
+
+/* Number of bytes child-pipe-write sends down its stdout.  More
+   than a pipe holds, so that the writer has to wait for the
+   reader. */
+#define PIPE_DATA_SIZE (3 * 4096 + 123)
+
+/* Returns byte I of the data child-pipe-write sends. */
+static inline char
+pipe_data_byte (int i) 
+{
+  return 'a' + i % 23;
+}
+
+#endif /* tests/userprog/pipe-data.h */
@@ -0,0 +1,34 @@
+/* Gives a pipe a second write end with dup2() and checks that
+   the read end reports end of file only after both write ends
+   have been closed, and not before the buffered data has been
+   read. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char buf[16];
+  int fds[2], spare[2];
+
+  CHECK (pipe (fds), "pipe");
+  CHECK (pipe (spare), "pipe");
+  CHECK (dup2 (fds[1], spare[0]) == spare[0],
+         "dup2 write end onto another fd");
+  close (spare[1]);
+
+  CHECK (write (fds[1], "abc", 3) == 3, "write \"abc\"");
+  msg ("close first write end");
+  close (fds[1]);
+  CHECK (write (spare[0], "def", 3) == 3, "write \"def\" to second write end");
+  msg ("close second write end");
+  close (spare[0]);
+
+  CHECK (read (fds[0], buf, sizeof buf) == 6, "read 6 bytes");
+  if (memcmp (buf, "abcdef", 6))
+    fail ("read wrong data");
+  CHECK (read (fds[0], buf, sizeof buf) == 0, "read end of file");
+}
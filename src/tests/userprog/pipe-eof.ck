@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pipe-eof) begin
+(pipe-eof) pipe
+(pipe-eof) pipe
+(pipe-eof) dup2 write end onto another fd
+(pipe-eof) write "abc"
+(pipe-eof) close first write end
+(pipe-eof) write "def" to second write end
+(pipe-eof) close second write end
+(pipe-eof) read 6 bytes
+(pipe-eof) read end of file
+(pipe-eof) end
+pipe-eof: exit(0)
+EOF
+pass;
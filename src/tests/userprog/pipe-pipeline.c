@@ -0,0 +1,38 @@
+/* Connects two children with a pipe the way the shell runs
+   "child-pipe-write | child-pipe-read": the first child's stdout
+   and the second child's stdin are the two ends of the pipe. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  int fds[2];
+  pid_t writer, reader;
+
+  CHECK (pipe (fds), "pipe");
+
+  /* Nothing may be written to stdout while it is redirected. */
+  if (dup2 (fds[1], STDOUT_FILENO) != STDOUT_FILENO)
+    fail ("dup2 onto stdout failed");
+  writer = exec ("child-pipe-write");
+  close (STDOUT_FILENO);
+  close (fds[1]);
+  if (writer == PID_ERROR)
+    fail ("exec \"child-pipe-write\" failed");
+  msg ("exec \"child-pipe-write\"");
+
+  CHECK (dup2 (fds[0], STDIN_FILENO) == STDIN_FILENO,
+         "dup2 onto stdin");
+  reader = exec ("child-pipe-read");
+  close (STDIN_FILENO);
+  close (fds[0]);
+  if (reader == PID_ERROR)
+    fail ("exec \"child-pipe-read\" failed");
+
+  CHECK (wait (reader) == 0, "wait for child-pipe-read");
+  CHECK (wait (writer) == 0, "wait for child-pipe-write");
+}
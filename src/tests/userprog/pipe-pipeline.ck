@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pipe-pipeline) begin
+(pipe-pipeline) pipe
+(pipe-pipeline) exec "child-pipe-write"
+(pipe-pipeline) dup2 onto stdin
+child-pipe-write: exit(0)
+(child-pipe-read) read 12411 bytes
+child-pipe-read: exit(0)
+(pipe-pipeline) wait for child-pipe-read
+(pipe-pipeline) wait for child-pipe-write
+(pipe-pipeline) end
+pipe-pipeline: exit(0)
+EOF
+pass;
@@ -0,0 +1,48 @@
+/* Runs a child whose stdout is a pipe and which writes more than
+   the pipe holds, and reads it all back through the other end.
+   Both sides have to wait for each other.  Once the child exits,
+   nothing holds the write end open any more, so the read end
+   must report end of file. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/userprog/pipe-data.h"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char buf[1000];
+  int fds[2];
+  int total = 0;
+  int cnt;
+  pid_t pid;
+
+  CHECK (pipe (fds), "pipe");
+
+  /* Nothing may be written to stdout while it is redirected. */
+  if (dup2 (fds[1], STDOUT_FILENO) != STDOUT_FILENO)
+    fail ("dup2 onto stdout failed");
+  pid = exec ("child-pipe-write");
+  close (STDOUT_FILENO);
+  close (fds[1]);
+  if (pid == PID_ERROR)
+    fail ("exec \"child-pipe-write\" failed");
+  msg ("exec \"child-pipe-write\"");
+
+  while ((cnt = read (fds[0], buf, sizeof buf)) > 0)
+    {
+      int i;
+
+      for (i = 0; i < cnt; i++)
+        if (total + i >= PIPE_DATA_SIZE
+            || buf[i] != pipe_data_byte (total + i))
+          fail ("bad byte at offset %d", total + i);
+      total += cnt;
+    }
+  if (total != PIPE_DATA_SIZE)
+    fail ("read %d bytes, expected %d", total, PIPE_DATA_SIZE);
+  msg ("read %d bytes then end of file", total);
+  CHECK (wait (pid) == 0, "wait for child-pipe-write");
+}
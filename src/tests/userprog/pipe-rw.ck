@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pipe-rw) begin
+(pipe-rw) pipe
+(pipe-rw) exec "child-pipe-write"
+child-pipe-write: exit(0)
+(pipe-rw) read 12411 bytes then end of file
+(pipe-rw) wait for child-pipe-write
+(pipe-rw) end
+pipe-rw: exit(0)
+EOF
+pass;
@@ -0,0 +1,70 @@
+/* Submits a batch through the syscall ring in which some
+   requests are bad: a kernel buffer, an unmapped buffer, a bad
+   fd and an unknown opcode.  Each of those must fail with -1 in
+   its own completion, without killing the process or affecting
+   the valid requests around them. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static struct syscall_ring ring;
+static char buf[sizeof sample];
+
+static void
+submit (uint32_t op, int fd, void *data, uint32_t len, uint32_t user_data)
+{
+  struct ring_sqe *sqe = &ring.sq[ring.sq_tail % RING_ENTRIES];
+
+  sqe->op = op;
+  sqe->fd = fd;
+  sqe->buf = data;
+  sqe->len = len;
+  sqe->ofs = 0;
+  sqe->user_data = user_data;
+  ring.sq_tail++;
+}
+
+static void
+reap (uint32_t user_data, int res)
+{
+  struct ring_cqe *cqe;
+
+  if (ring.cq_head == ring.cq_tail)
+    fail ("no completion for request %u", user_data);
+  cqe = &ring.cq[ring.cq_head++ % RING_ENTRIES];
+  if (cqe->user_data != user_data || cqe->res != res)
+    fail ("completion (%u, %d), expected (%u, %d)",
+          cqe->user_data, cqe->res, user_data, res);
+}
+
+void
+test_main (void)
+{
+  int handle;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (ring_setup (&ring), "ring_setup");
+
+  submit (RING_NOP, 0, NULL, 0, 1);
+  submit (RING_READ, handle, (void *) 0xc0000000, 16, 2);
+  submit (RING_OPEN, 0, (void *) 0x20101234, 0, 3);
+  submit (RING_PREAD, handle, buf, sizeof sample - 1, 4);
+  submit (RING_WRITE, 0x20101234, buf, 16, 5);
+  submit (0x1234, handle, buf, 16, 6);
+  submit (RING_NOP, 0, NULL, 0, 7);
+  CHECK (ring_enter (7) == 7, "ring_enter (7)");
+
+  reap (1, 0);
+  reap (2, -1);
+  reap (3, -1);
+  reap (4, sizeof sample - 1);
+  reap (5, -1);
+  reap (6, -1);
+  reap (7, 0);
+  if (memcmp (buf, sample, sizeof sample - 1))
+    fail ("good read in the batch returned wrong data");
+  msg ("only the bad requests failed");
+}
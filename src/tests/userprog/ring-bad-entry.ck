@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(ring-bad-entry) begin
+(ring-bad-entry) open "sample.txt"
+(ring-bad-entry) ring_setup
+(ring-bad-entry) ring_enter (7)
+(ring-bad-entry) only the bad requests failed
+(ring-bad-entry) end
+ring-bad-entry: exit(0)
+EOF
+pass;
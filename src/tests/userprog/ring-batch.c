@@ -0,0 +1,66 @@
+/* Writes a file and reads it back through the syscall ring,
+   submitting all three requests with a single ring_enter(), and
+   checks that they complete in order with the right results. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static struct syscall_ring ring;
+static char buf[sizeof sample];
+
+static void
+submit (enum ring_op op, int fd, void *data, uint32_t len,
+        uint32_t ofs, uint32_t user_data)
+{
+  struct ring_sqe *sqe = &ring.sq[ring.sq_tail % RING_ENTRIES];
+
+  sqe->op = op;
+  sqe->fd = fd;
+  sqe->buf = data;
+  sqe->len = len;
+  sqe->ofs = ofs;
+  sqe->user_data = user_data;
+  ring.sq_tail++;
+}
+
+static void
+reap (uint32_t user_data, int res)
+{
+  struct ring_cqe *cqe;
+
+  if (ring.cq_head == ring.cq_tail)
+    fail ("no completion for request %u", user_data);
+  cqe = &ring.cq[ring.cq_head++ % RING_ENTRIES];
+  if (cqe->user_data != user_data || cqe->res != res)
+    fail ("completion (%u, %d), expected (%u, %d)",
+          cqe->user_data, cqe->res, user_data, res);
+}
+
+void
+test_main (void) 
+{
+  int handle;
+
+  CHECK (create ("ring.txt", sizeof sample - 1), "create \"ring.txt\"");
+  CHECK ((handle = open ("ring.txt")) > 1, "open \"ring.txt\"");
+  CHECK (ring_setup (&ring), "ring_setup");
+
+  submit (RING_PWRITE, handle, sample, sizeof sample - 1, 0, 1);
+  submit (RING_PREAD, handle, buf, sizeof sample - 1, 0, 2);
+  submit (RING_FILESIZE, handle, NULL, 0, 0, 3);
+  CHECK (ring_enter (3) == 3, "ring_enter (3)");
+
+  reap (1, sizeof sample - 1);
+  reap (2, sizeof sample - 1);
+  reap (3, sizeof sample - 1);
+  if (ring.cq_head != ring.cq_tail)
+    fail ("extra completions");
+  if (memcmp (buf, sample, sizeof sample - 1))
+    fail ("data read back differs from data written");
+  msg ("completions match");
+
+  check_file ("ring.txt", sample, sizeof sample - 1);
+}
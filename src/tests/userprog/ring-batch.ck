@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(ring-batch) begin
+(ring-batch) create "ring.txt"
+(ring-batch) open "ring.txt"
+(ring-batch) ring_setup
+(ring-batch) ring_enter (3)
+(ring-batch) completions match
+(ring-batch) open "ring.txt" for verification
+(ring-batch) verified contents of "ring.txt"
+(ring-batch) close "ring.txt"
+(ring-batch) end
+ring-batch: exit(0)
+EOF
+pass;
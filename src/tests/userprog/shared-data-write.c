@@ -0,0 +1,14 @@
+/* Attempts to write to the shared data page, which the kernel
+   maps into every process read-only.  This should terminate the
+   process with a -1 exit code. */
+
+#include <shared-data.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  *(volatile int *) SHARED_DATA_ADDR = 42;
+  fail ("should have exited with -1");
+}
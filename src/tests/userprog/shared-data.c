@@ -0,0 +1,51 @@
+/* Reads the shared data page through getticks(), gettime() and
+   getpid().  The clocks must not run backward across a busy loop
+   that lasts until they advance, and an exec'd child must see
+   its own process id, the one exec() returned, rather than its
+   parent's.  The child writes the id it sees to a file. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  int64_t ticks, time, start_ticks, start_time;
+  pid_t self, child, seen;
+  int handle;
+
+  start_ticks = ticks = getticks ();
+  start_time = time = gettime ();
+  while (ticks == start_ticks || time == start_time)
+    {
+      int64_t now_ticks = getticks ();
+      int64_t now_time = gettime ();
+
+      if (now_ticks < ticks)
+        fail ("getticks() went from %lld to %lld", ticks, now_ticks);
+      if (now_time < time)
+        fail ("gettime() went from %lld to %lld", time, now_time);
+      ticks = now_ticks;
+      time = now_time;
+    }
+  msg ("clocks advance");
+
+  self = getpid ();
+  CHECK (create ("child-pid.txt", sizeof seen), "create \"child-pid.txt\"");
+  CHECK ((child = exec ("child-getpid")) != PID_ERROR,
+         "exec \"child-getpid\"");
+  CHECK (wait (child) == 0, "wait for child-getpid");
+  CHECK ((handle = open ("child-pid.txt")) > 1, "open \"child-pid.txt\"");
+  CHECK (read (handle, &seen, sizeof seen) == sizeof seen,
+         "read \"child-pid.txt\"");
+  close (handle);
+
+  if (seen == self)
+    fail ("child saw its parent's pid %d", self);
+  if (seen != child)
+    fail ("child saw pid %d, but exec() returned %d", seen, child);
+  if (getpid () != self)
+    fail ("pid changed from %d to %d", self, getpid ());
+  msg ("child saw its own pid");
+}
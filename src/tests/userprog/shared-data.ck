@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(shared-data) begin
+(shared-data) clocks advance
+(shared-data) create "child-pid.txt"
+(shared-data) exec "child-getpid"
+(child-getpid) open "child-pid.txt"
+child-getpid: exit(0)
+(shared-data) wait for child-getpid
+(shared-data) open "child-pid.txt"
+(shared-data) read "child-pid.txt"
+(shared-data) child saw its own pid
+(shared-data) end
+shared-data: exit(0)
+EOF
+pass;
@@ -0,0 +1,25 @@
+/* Passes bad status pointers to wait_any() while a child is
+   alive.  Each call must return -1 without reaping the child,
+   which a call with a good pointer then does. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void)
+{
+  pid_t child;
+  int null_result, kernel_result, status;
+
+  if ((child = exec ("child-exit 3")) == PID_ERROR)
+    fail ("exec \"child-exit 3\" failed");
+  null_result = wait_any (NULL);
+  kernel_result = wait_any ((int *) 0xc0100000);
+
+  /* Print nothing until the child is gone. */
+  if (wait_any (&status) != child || status != 3)
+    fail ("child was not left to reap");
+  CHECK (null_result == -1, "wait_any with null pointer");
+  CHECK (kernel_result == -1, "wait_any with kernel pointer");
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(wait-any-bad-ptr) begin
+child-exit: exit(3)
+(wait-any-bad-ptr) wait_any with null pointer
+(wait-any-bad-ptr) wait_any with kernel pointer
+(wait-any-bad-ptr) end
+wait-any-bad-ptr: exit(0)
+EOF
+pass;
@@ -0,0 +1,31 @@
+/* Executes two children with different exit codes and reaps
+   both with wait_any(), in whatever order they exit.  Once both
+   are reaped, wait_any() must fail at once. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  pid_t a, b, first, second;
+  int first_status, second_status;
+
+  if ((a = exec ("child-exit 3")) == PID_ERROR
+      || (b = exec ("child-exit 5")) == PID_ERROR)
+    fail ("exec \"child-exit\" failed");
+  first = wait_any (&first_status);
+  second = wait_any (&second_status);
+
+  /* Print nothing until both children are gone. */
+  if (!((first == a && second == b) || (first == b && second == a)))
+    fail ("wait_any() returned %d and %d, expected %d and %d",
+          first, second, a, b);
+  if (first_status != (first == a ? 3 : 5)
+      || second_status != (second == a ? 3 : 5))
+    fail ("wrong exit status %d for pid %d or %d for pid %d",
+          first_status, first, second_status, second);
+  msg ("reaped both children");
+  CHECK (wait_any (&first_status) == -1, "wait_any with no children");
+}
@@ -0,0 +1,22 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF', <<'EOF']);
+(wait-any) begin
+child-exit: exit(3)
+child-exit: exit(5)
+(wait-any) reaped both children
+(wait-any) wait_any with no children
+(wait-any) end
+wait-any: exit(0)
+EOF
+(wait-any) begin
+child-exit: exit(5)
+child-exit: exit(3)
+(wait-any) reaped both children
+(wait-any) wait_any with no children
+(wait-any) end
+wait-any: exit(0)
+EOF
+pass;
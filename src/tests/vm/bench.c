@@ -0,0 +1,78 @@
+/* Shared code for the page replacement benchmarks, which touch
+   the pages of a large array in different patterns.  The pages
+   are filled with random data, so that they don't compress, and
+   each one holds a counter of the writes to it in its first
+   word.  At the end, every counter and the checksum of the rest
+   of every page must be as expected. */
+
+#include "tests/vm/bench.h"
+#include "tests/arc4.h"
+#include "tests/cksum.h"
+#include "tests/lib.h"
+
+#define PAGE_SIZE 4096
+
+static char pages[BENCH_PAGES][PAGE_SIZE];
+static unsigned counts[BENCH_PAGES];      /* Expected counter in each page. */
+static unsigned long sums[BENCH_PAGES];   /* Checksum of the rest of each. */
+static struct arc4 arc4;
+
+/* Fills the pages with random data. */
+void
+bench_init (void)
+{
+  size_t i;
+
+  msg ("init");
+  arc4_init (&arc4, "foobar", 6);
+  arc4_crypt (&arc4, pages, sizeof pages);
+  for (i = 0; i < BENCH_PAGES; i++)
+    {
+      *(unsigned *) pages[i] = 0;
+      sums[i] = cksum (pages[i] + sizeof (unsigned),
+                       PAGE_SIZE - sizeof (unsigned));
+    }
+}
+
+/* Returns a random number. */
+unsigned
+bench_random (void)
+{
+  unsigned r = 0;
+
+  arc4_crypt (&arc4, &r, sizeof r);
+  return r;
+}
+
+/* Reads PAGE, and also writes it if WRITE is true. */
+void
+bench_touch (size_t page, bool write)
+{
+  volatile unsigned *counter = (unsigned *) pages[page];
+
+  if (*counter != counts[page])
+    fail ("page %zu: counter is %u, not %u", page, *counter, counts[page]);
+  if (write)
+    {
+      ++*counter;
+      counts[page]++;
+    }
+}
+
+/* Checks that every page holds what it should. */
+void
+bench_verify (void)
+{
+  size_t i;
+
+  msg ("verify");
+  for (i = 0; i < BENCH_PAGES; i++)
+    {
+      if (*(unsigned *) pages[i] != counts[i])
+        fail ("page %zu: counter is %u, not %u",
+              i, *(unsigned *) pages[i], counts[i]);
+      if (cksum (pages[i] + sizeof (unsigned), PAGE_SIZE - sizeof (unsigned))
+          != sums[i])
+        fail ("page %zu: bad checksum", i);
+    }
+}
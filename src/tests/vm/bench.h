@@ -0,0 +1,16 @@
+#ifndef TESTS_VM_BENCH_H
+#define TESTS_VM_BENCH_H 1
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Number of pages the benchmarks touch.  This is well over the
+   256 frames that bench.pl gives the kernel by default. */
+#define BENCH_PAGES 640
+
+void bench_init (void);
+unsigned bench_random (void);
+void bench_touch (size_t page, bool write);
+void bench_verify (void);
+
+#endif /* tests/vm/bench.h */
@@ -0,0 +1,61 @@
+#! /usr/bin/perl
+
+# Runs each page replacement benchmark under each policy and
+# prints a table of the page faults, evictions and swap traffic
+# that the kernel reports when it powers off.  Each run's output
+# is kept in tests/vm/bench/POLICY/PROGRAM.output and checked
+# against PROGRAM.ck.  Run from the build directory:
+#
+#	bench.pl SRC_DIR USER_PAGES POLICY... -- PROGRAM...
+
+use strict;
+use warnings;
+use File::Basename;
+use File::Path;
+
+@ARGV >= 4 || die "usage: $0 SRC_DIR USER_PAGES POLICY... -- PROGRAM...\n";
+my ($src_dir, $user_pages) = splice (@ARGV, 0, 2);
+my ($sep) = grep ($ARGV[$_] eq '--', 0..$#ARGV);
+defined $sep || die "$0: missing `--'\n";
+my (@policies) = @ARGV[0..$sep - 1];
+my (@programs) = @ARGV[$sep + 1..$#ARGV];
+
+my (@columns) = ('faults', 'evicted', 'swap out', 'swap in',
+		 'disk wr', 'disk rd');
+printf "%-16s %-6s" . " %9s" x @columns . "  %s\n",
+  'program', 'policy', @columns, 'result';
+
+for my $program (@programs) {
+    my ($name) = basename ($program);
+    for my $policy (@policies) {
+	my ($prefix) = "tests/vm/bench/$policy/$name";
+	mkpath (dirname ($prefix));
+	xsystem ("pintos -v -k -T 600 --swap-size=4 -p $program -a $name "
+		 . "-- -q -ul=$user_pages -vm-policy=$policy -f run $name "
+		 . "< /dev/null 2> $prefix.errors > $prefix.output");
+	system ("perl -I$src_dir $src_dir/$program.ck $prefix $prefix.result");
+
+	my (@stats) = ('?') x @columns;
+	open (OUTPUT, '<', "$prefix.output") || die "$prefix.output: $!\n";
+	while (<OUTPUT>) {
+	    $stats[0] = $1 if /^Exception: (\d+) page faults/;
+	    $stats[1] = $1 if /^Frame: \S+ policy, (\d+) evictions/;
+	    @stats[2..5] = ($1, $2, $3, $4)
+	      if /^Swap: (\d+) pages out, (\d+) pages in, (\d+) pages written to disk, (\d+) pages read from disk/;
+	}
+	close (OUTPUT);
+
+	open (RESULT, '<', "$prefix.result") || die "$prefix.result: $!\n";
+	my ($result) = <RESULT>;
+	close (RESULT);
+	chomp $result;
+
+	printf "%-16s %-6s" . " %9s" x @columns . "  %s\n",
+	  $name, $policy, @stats, $result;
+    }
+}
+
+sub xsystem {
+    my ($command) = @_;
+    system ($command) == 0 || warn "$command: exit status $?\n";
+}
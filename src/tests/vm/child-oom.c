@@ -0,0 +1,47 @@
+/* Child process of page-oom.
+
+   Writes a different word to each of the number of pages given
+   as its first argument, so that no two of them can be merged.
+   With a second argument, "hold", it then tells its parent by
+   writing a byte to its stdout, which the parent has redirected
+   to a pipe, and spins without touching its pages again until
+   the out-of-memory killer ends it.  Otherwise it checks its
+   pages and exits with code 0, or 1 if one is wrong.  It cannot
+   report errors with msg(), since its stdout may be the pipe. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syscall.h>
+
+const char *test_name = "child-oom";
+
+#define PAGE_MAX 960
+#define PAGE_WORDS (4096 / sizeof (int))
+
+static int buf[PAGE_MAX][PAGE_WORDS];
+
+int
+main (int argc, char *argv[])
+{
+  int page_cnt = argc > 1 ? atoi (argv[1]) : 0;
+  int i;
+
+  if (page_cnt > PAGE_MAX)
+    return 1;
+  for (i = 0; i < page_cnt; i++)
+    buf[i][0] = buf[i][PAGE_WORDS - 1] = i + 1;
+
+  if (argc > 2 && !strcmp (argv[2], "hold"))
+    {
+      if (write (STDOUT_FILENO, "", 1) != 1)
+        return 1;
+      for (;;)
+        getticks ();
+    }
+
+  for (i = 0; i < page_cnt; i++)
+    if (buf[i][0] != i + 1 || buf[i][PAGE_WORDS - 1] != i + 1)
+      return 1;
+  return 0;
+}
@@ -0,0 +1,23 @@
+/* Passes madvise() an unaligned address, unmapped and kernel
+   ranges, and unknown advice, each of which must fail with -1
+   without killing the process. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char page[4096] __attribute__ ((aligned (4096)));
+
+void
+test_main (void)
+{
+  CHECK (madvise (page + 1, sizeof page - 1, MADV_DONTNEED) == -1,
+         "madvise unaligned address");
+  CHECK (madvise ((void *) 0x10000000, 4096, MADV_DONTNEED) == -1,
+         "madvise unmapped page");
+  CHECK (madvise ((void *) 0xc0000000, 4096, MADV_DONTNEED) == -1,
+         "madvise kernel page");
+  CHECK (madvise (page, sizeof page, 1234) == -1, "madvise unknown advice");
+  CHECK (madvise (page, sizeof page, MADV_DONTNEED) == 0,
+         "madvise good page");
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(madvise-bad) begin
+(madvise-bad) madvise unaligned address
+(madvise-bad) madvise unmapped page
+(madvise-bad) madvise kernel page
+(madvise-bad) madvise unknown advice
+(madvise-bad) madvise good page
+(madvise-bad) end
+EOF
+pass;
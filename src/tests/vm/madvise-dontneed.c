@@ -0,0 +1,55 @@
+/* Discards pages with MADV_DONTNEED and checks what they read
+   back as afterward: an anonymous page as zeros, a page of the
+   executable's data segment as the executable holds it, and a
+   page of a mapped file as the file holds it, which includes
+   what was written through the mapping beforehand. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define ACTUAL ((void *) 0x10000000)
+
+static char anon[4096] __attribute__ ((aligned (4096)));
+static char data[4096] __attribute__ ((aligned (4096))) = "data segment";
+static char buf[sizeof sample];
+
+void
+test_main (void)
+{
+  int handle;
+  mapid_t map;
+  size_t i;
+
+  memset (anon, 'a', sizeof anon);
+  CHECK (madvise (anon, sizeof anon, MADV_DONTNEED) == 0,
+         "madvise anonymous page");
+  for (i = 0; i < sizeof anon; i++)
+    if (anon[i] != 0)
+      fail ("byte %zu of anonymous page has value %02hhx (should be 0)",
+            i, anon[i]);
+
+  memset (data, 'd', sizeof data);
+  CHECK (madvise (data, sizeof data, MADV_DONTNEED) == 0,
+         "madvise data page");
+  if (memcmp (data, "data segment", sizeof "data segment"))
+    fail ("data page did not read back from the executable");
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK ((map = mmap (handle, ACTUAL)) != MAP_FAILED, "mmap \"sample.txt\"");
+  memcpy (buf, sample, strlen (sample));
+  memcpy (buf, "madvise", 7);
+  memcpy (ACTUAL, "madvise", 7);
+  CHECK (madvise (ACTUAL, 4096, MADV_DONTNEED) == 0, "madvise mapped page");
+  if (memcmp (ACTUAL, buf, strlen (sample)))
+    fail ("mapped page did not read back from the file");
+  munmap (map);
+
+  CHECK (read (handle, buf, strlen (sample)) == (int) strlen (sample),
+         "read \"sample.txt\"");
+  if (memcmp (buf, "madvise", 7))
+    fail ("write through the mapping did not reach the file");
+  close (handle);
+}
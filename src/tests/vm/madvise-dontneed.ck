@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(madvise-dontneed) begin
+(madvise-dontneed) madvise anonymous page
+(madvise-dontneed) madvise data page
+(madvise-dontneed) open "sample.txt"
+(madvise-dontneed) mmap "sample.txt"
+(madvise-dontneed) madvise mapped page
+(madvise-dontneed) read "sample.txt"
+(madvise-dontneed) end
+EOF
+pass;
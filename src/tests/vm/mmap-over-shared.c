@@ -0,0 +1,17 @@
+/* Verifies that mapping over the page the kernel shares with
+   every process is disallowed. */
+
+#include <shared-data.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  int handle;
+  
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (mmap (handle, SHARED_DATA_ADDR) == MAP_FAILED,
+         "try to mmap over shared data page");
+}
@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mmap-over-shared) begin
+(mmap-over-shared) open "sample.txt"
+(mmap-over-shared) try to mmap over shared data page
+(mmap-over-shared) end
+EOF
+pass;
@@ -0,0 +1,94 @@
+/* Checks that the 2q policy's Am queue is LRU: a page in Am that
+   is touched again between evictions outlives pages that went
+   into Am after it but are not touched again.
+
+   The test runs under -vm-policy=2q -rss=48, so that it evicts
+   only its own pages, always from Am first.  Pages of a mapped
+   file reach Am by being evicted from A1in and touched again.
+   Whether a clean mapped page was evicted shows in what it reads
+   back after its file is rewritten with write(): a page still
+   resident keeps its old contents. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define ACTUAL ((char *) 0x10000000)
+#define PAGE 4096
+
+/* Layout of the mapping, in pages. */
+#define PAD_CNT 8               /* Go into Am first, ahead of HOT. */
+#define COLD_CNT 16             /* Go into Am after HOT. */
+#define FILL_CNT 64             /* Push the above out of A1in. */
+#define NEW_CNT 32              /* Evict from Am. */
+
+#define PAD 0
+#define HOT (PAD + PAD_CNT)
+#define COLD (HOT + 1)
+#define FILL (COLD + COLD_CNT)
+#define NEW (FILL + FILL_CNT)
+#define PAGE_CNT (NEW + NEW_CNT)
+
+static void
+touch (size_t page)
+{
+  volatile char *p = ACTUAL + page * PAGE;
+  (void) *p;
+}
+
+/* Writes 'x' to the first byte of PAGE of the file. */
+static void
+rewrite (int handle, size_t page)
+{
+  seek (handle, page * PAGE);
+  if (write (handle, "x", 1) != 1)
+    fail ("write to page %zu failed", page);
+}
+
+void
+test_main (void)
+{
+  int handle;
+  mapid_t map;
+  size_t i;
+
+  CHECK (create ("twoq", PAGE_CNT * PAGE), "create \"twoq\"");
+  CHECK ((handle = open ("twoq")) > 1, "open \"twoq\"");
+  CHECK ((map = mmap (handle, ACTUAL)) != MAP_FAILED, "mmap \"twoq\"");
+  CHECK (madvise (ACTUAL, PAGE_CNT * PAGE, MADV_RANDOM) == 0,
+         "madvise random");
+
+  /* Load the pads, the hot page and the cold pages into A1in,
+     then fill memory until they are evicted from it. */
+  for (i = PAD; i < FILL; i++)
+    touch (i);
+  for (i = FILL; i < NEW; i++)
+    touch (i);
+
+  /* Make room, then touch them again: they go into Am, in order. */
+  CHECK (madvise (ACTUAL + FILL * PAGE, FILL_CNT * PAGE, MADV_DONTNEED) == 0,
+         "madvise dontneed");
+  for (i = PAD; i < FILL; i++)
+    touch (i);
+
+  /* From here on, a page reads 'x' if it has been loaded again. */
+  rewrite (handle, HOT);
+  rewrite (handle, COLD);
+
+  /* Evict from Am, touching the hot page before each eviction. */
+  for (i = NEW; i < PAGE_CNT; i++)
+    {
+      touch (HOT);
+      touch (i);
+    }
+
+  if (ACTUAL[HOT * PAGE] != 0)
+    fail ("hot page was evicted ahead of older cold pages");
+  if (ACTUAL[COLD * PAGE] != 'x')
+    fail ("no cold page was evicted");
+  msg ("hot page survived");
+
+  munmap (map);
+  close (handle);
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-2q-hot) begin
+(page-2q-hot) create "twoq"
+(page-2q-hot) open "twoq"
+(page-2q-hot) mmap "twoq"
+(page-2q-hot) madvise random
+(page-2q-hot) madvise dontneed
+(page-2q-hot) hot page survived
+(page-2q-hot) end
+EOF
+pass;
@@ -0,0 +1,36 @@
+/* Runs out of memory and swap on purpose.  A first child fills
+   most of both and then stays runnable.  A second, smaller one
+   then needs more than is left, so the out-of-memory killer must
+   end the first child, which uses the most, and not the second
+   child or this process, which is blocked waiting. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void)
+{
+  pid_t big, small;
+  int fds[2];
+  char c;
+
+  CHECK (pipe (fds), "pipe");
+
+  /* Nothing may be written to stdout while it is redirected. */
+  if (dup2 (fds[1], STDOUT_FILENO) != STDOUT_FILENO)
+    fail ("dup2 onto stdout failed");
+  big = exec ("child-oom 960 hold");
+  close (STDOUT_FILENO);
+  close (fds[1]);
+  if (big == PID_ERROR)
+    fail ("exec \"child-oom 960 hold\" failed");
+  msg ("exec \"child-oom 960 hold\"");
+  CHECK (read (fds[0], &c, 1) == 1, "wait for it to fill memory");
+
+  CHECK ((small = exec ("child-oom 512")) != PID_ERROR,
+         "exec \"child-oom 512\"");
+  CHECK (wait (small) == 0, "wait for child-oom 512");
+  CHECK (wait (big) == -1, "wait for child-oom 960 hold");
+}
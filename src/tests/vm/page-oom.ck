@@ -0,0 +1,25 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+my (@kills) = grep (/^Out of memory: killed process/, @output);
+fail "expected one out-of-memory kill, found " . scalar (@kills) . "\n"
+  if @kills != 1;
+@output = grep (!/^Out of memory: killed process/, @output);
+compare_output ("run", IGNORE_EXIT_CODES => 1, \@output, [<<'EOF']);
+(page-oom) begin
+(page-oom) pipe
+(page-oom) exec "child-oom 960 hold"
+(page-oom) wait for it to fill memory
+(page-oom) exec "child-oom 512"
+(page-oom) wait for child-oom 512
+(page-oom) wait for child-oom 960 hold
+(page-oom) end
+EOF
+pass;
@@ -0,0 +1,17 @@
+/* Runs child-linear, which works through 1 MB of memory, with a
+   resident set limit of 32 pages.  It must still finish
+   correctly, by evicting its own pages to make room for others. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void)
+{
+  pid_t child;
+
+  CHECK ((child = exec_rss ("child-linear", 32)) != -1,
+         "exec_rss \"child-linear\" with 32 pages");
+  CHECK (wait (child) == 0x42, "wait for child-linear");
+}
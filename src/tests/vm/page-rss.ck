@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-rss) begin
+(page-rss) exec_rss "child-linear" with 32 pages
+(page-rss) wait for child-linear
+(page-rss) end
+EOF
+pass;
@@ -0,0 +1,23 @@
+/* Writes, over and over, a loop of pages somewhat larger than
+   memory: the worst case for LRU, which always evicts the page
+   needed soonest. */
+
+#include "tests/vm/bench.h"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define LOOP_PAGES 320
+#define PASS_CNT 40
+
+void
+test_main (void)
+{
+  size_t pass, i;
+
+  bench_init ();
+  msg ("loop over %d pages %d times", LOOP_PAGES, PASS_CNT);
+  for (pass = 0; pass < PASS_CNT; pass++)
+    for (i = 0; i < LOOP_PAGES; i++)
+      bench_touch (i, true);
+  bench_verify ();
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(vm-bench-loop) begin
+(vm-bench-loop) init
+(vm-bench-loop) loop over 320 pages 40 times
+(vm-bench-loop) verify
+(vm-bench-loop) end
+EOF
+pass;
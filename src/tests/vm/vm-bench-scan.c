@@ -0,0 +1,30 @@
+/* Keeps writing a small hot set of pages, interrupted by reads
+   of a long run of cold pages, each of which is touched only
+   once per round.  A policy that lets the scan push the hot set
+   out of memory does badly. */
+
+#include "tests/vm/bench.h"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define HOT_PAGES 128
+#define HOT_PASSES 10
+#define ROUND_CNT 10
+
+void
+test_main (void)
+{
+  size_t round, pass, i;
+
+  bench_init ();
+  msg ("%d rounds of hot set and scan", ROUND_CNT);
+  for (round = 0; round < ROUND_CNT; round++)
+    {
+      for (pass = 0; pass < HOT_PASSES; pass++)
+        for (i = 0; i < HOT_PAGES; i++)
+          bench_touch (i, true);
+      for (i = HOT_PAGES; i < BENCH_PAGES; i++)
+        bench_touch (i, false);
+    }
+  bench_verify ();
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(vm-bench-scan) begin
+(vm-bench-scan) init
+(vm-bench-scan) 10 rounds of hot set and scan
+(vm-bench-scan) verify
+(vm-bench-scan) end
+EOF
+pass;
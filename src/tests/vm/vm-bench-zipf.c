@@ -0,0 +1,55 @@
+/* Touches pages at random with a Zipf distribution: the page of
+   rank R is touched in proportion to 1 / R.  One touch in four
+   is a write.  The ranks are scattered over the array, so that
+   hot pages are not neighbors. */
+
+#include "tests/vm/bench.h"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define TOUCH_CNT 20000
+
+/* Sum of the weights of the ranks up to and including each. */
+static unsigned cumulative[BENCH_PAGES];
+
+/* Returns a random rank. */
+static size_t
+zipf (void)
+{
+  unsigned r = bench_random () % cumulative[BENCH_PAGES - 1];
+  size_t lo = 0, hi = BENCH_PAGES - 1;
+
+  /* Find the first rank whose cumulative weight exceeds R. */
+  while (lo < hi)
+    {
+      size_t mid = (lo + hi) / 2;
+      if (cumulative[mid] > r)
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+  return lo;
+}
+
+void
+test_main (void)
+{
+  unsigned sum = 0;
+  size_t i;
+
+  bench_init ();
+  for (i = 0; i < BENCH_PAGES; i++)
+    {
+      sum += 65536 / (i + 1);
+      cumulative[i] = sum;
+    }
+
+  msg ("%d Zipf-distributed touches", TOUCH_CNT);
+  for (i = 0; i < TOUCH_CNT; i++)
+    {
+      /* 263 is prime, so this maps ranks to pages one-to-one. */
+      size_t page = zipf () * 263 % BENCH_PAGES;
+      bench_touch (page, bench_random () % 4 == 0);
+    }
+  bench_verify ();
+}
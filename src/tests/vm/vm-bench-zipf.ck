@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(vm-bench-zipf) begin
+(vm-bench-zipf) init
+(vm-bench-zipf) 20000 Zipf-distributed touches
+(vm-bench-zipf) verify
+(vm-bench-zipf) end
+EOF
+pass;
@@ -4,6 +4,7 @@
 #include <inttypes.h>
 #include <limits.h>
 #include <random.h>
+#include <round.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -24,8 +25,10 @@
 #include "threads/thread.h"
 #ifdef USERPROG
 #include "userprog/process.h"
+#include "userprog/aio.h"
 #include "userprog/exception.h"
 #include "userprog/gdt.h"
+#include "userprog/shared-data.h"
 #include "userprog/syscall.h"
 #include "userprog/tss.h"
 #else
@@ -34,9 +37,18 @@
 #ifdef FILESYS
 #include "devices/block.h"
 #include "devices/ide.h"
+#include "filesys/cache.h"
 #include "filesys/filesys.h"
 #include "filesys/fsutil.h"
 #endif
+#ifdef VM
+#include "vm/frame.h"
+#include "vm/ksm.h"
+#include "vm/policy.h"
+#include "vm/page.h"
+#include "vm/swap.h"
+#include "vm/zswap.h"
+#endif
 
 /* Page directory with kernel mappings only. */
 uint32_t *init_page_dir;
@@ -98,6 +110,10 @@ main (void)
   palloc_init (user_page_limit);
   malloc_init ();
   paging_init ();
+#ifdef VM
+  frame_init ();
+  page_init ();
+#endif
 
   /* Segmentation. */
 #ifdef USERPROG
@@ -113,6 +129,7 @@ main (void)
 #ifdef USERPROG
   exception_init ();
   syscall_init ();
+  shared_data_init ();
 #endif
 
   /* Start thread scheduler and enable interrupts. */
@@ -127,6 +144,17 @@ main (void)
   filesys_init (format_filesys);
 #endif
 
+#ifdef USERPROG
+  /* Start asynchronous I/O workers. */
+  aio_init ();
+#endif
+#ifdef VM
+  /* Start reclaiming frames and merging identical user pages in
+     the background. */
+  frame_pageout_init ();
+  ksm_init ();
+#endif
+
   printf ("Boot complete.\n");
   
   /* Run actions specified on kernel command line. */
@@ -153,7 +181,16 @@ bss_init (void)
 /* Populates the base page directory and page table with the
    kernel virtual mapping, and then sets up the CPU to use the
    new page directory.  Points init_page_dir to the page
-   directory it creates. */
+   directory it creates.
+
+   Each 4 MB of RAM that lies wholly within physical memory and
+   holds no kernel code is mapped with a single 4 MB page, which
+   takes one TLB entry and no page table.  The rest is mapped
+   with 4 kB pages, so that the kernel text stays read-only.
+
+   Every kernel mapping is global, since it is the same in every
+   page directory, so that switching page directories does not
+   flush it from the TLB. */
 static void
 paging_init (void)
 {
@@ -171,15 +208,30 @@ paging_init (void)
       size_t pte_idx = pt_no (vaddr);
       bool in_kernel_text = &_start <= vaddr && vaddr < &_end_kernel_text;
 
+      if (pte_idx == 0
+          && page + PTSPAN / PGSIZE <= init_ram_pages
+          && (vaddr + PTSPAN <= &_start || vaddr >= &_end_kernel_text))
+        {
+          pd[pde_idx] = pde_create_large (vaddr);
+          page += PTSPAN / PGSIZE - 1;
+          continue;
+        }
+
       if (pd[pde_idx] == 0)
         {
           pt = palloc_get_page (PAL_ASSERT | PAL_ZERO);
           pd[pde_idx] = pde_create (pt);
         }
 
-      pt[pte_idx] = pte_create_kernel (vaddr, !in_kernel_text);
+      pt[pte_idx] = pte_create_kernel (vaddr, !in_kernel_text) | PTE_G;
     }
 
+  /* Turn on CR4.PSE and CR4.PGE so that the CPU honors 4 MB
+     pages and global mappings.  See [IA32-v3a] 3.6.1 "Paging
+     Options". */
+  asm volatile ("movl %%cr4, %%eax; orl %0, %%eax; movl %%eax, %%cr4"
+                : : "i" (CR4_PSE | CR4_PGE) : "eax");
+
   /* Store the physical address of the page directory into CR3
      aka PDBR (page directory base register).  This activates our
      new page tables immediately.  See [IA32-v2a] "MOV--Move
@@ -247,6 +299,8 @@ parse_options (char **argv)
         filesys_bdev_name = value;
       else if (!strcmp (name, "-scratch"))
         scratch_bdev_name = value;
+      else if (!strcmp (name, "-cache"))
+        cache_sectors = atoi (value);
 #ifdef VM
       else if (!strcmp (name, "-swap"))
         swap_bdev_name = value;
@@ -259,6 +313,19 @@ parse_options (char **argv)
 #ifdef USERPROG
       else if (!strcmp (name, "-ul"))
         user_page_limit = atoi (value);
+#endif
+#ifdef VM
+      else if (!strcmp (name, "-stack"))
+        page_stack_max = ROUND_UP ((size_t) atoi (value) * 1024, PGSIZE);
+      else if (!strcmp (name, "-zswap"))
+        zswap_percent = atoi (value);
+      else if (!strcmp (name, "-rss"))
+        frame_rss_limit = atoi (value);
+      else if (!strcmp (name, "-vm-policy"))
+        {
+          if (!policy_select (value))
+            PANIC ("unknown page replacement policy `%s'", value);
+        }
 #endif
       else
         PANIC ("unknown option `%s' (use -h for help)", name);
@@ -373,6 +440,7 @@ usage (void)
           "  -f                 Format file system device during startup.\n"
           "  -filesys=BDEV      Use BDEV for file system instead of default.\n"
           "  -scratch=BDEV      Use BDEV for scratch instead of default.\n"
+          "  -cache=SECTORS     Cache SECTORS file system sectors (default 64).\n"
 #ifdef VM
           "  -swap=BDEV         Use BDEV for swap instead of default.\n"
 #endif
@@ -381,6 +449,15 @@ usage (void)
           "  -mlfqs             Use multi-level feedback queue scheduler.\n"
 #ifdef USERPROG
           "  -ul=COUNT          Limit user memory to COUNT pages.\n"
+#endif
+#ifdef VM
+          "  -stack=KB          Limit user stacks to KB kB (default 8192).\n"
+          "  -zswap=PERCENT     Let compressed swap grow to PERCENT%% of user memory\n"
+          "                     (default 20, 0 to disable).\n"
+          "  -rss=PAGES         Limit each process to PAGES resident pages by\n"
+          "                     default, past which it evicts its own pages.\n"
+          "  -vm-policy=NAME    Evict pages with NAME: clock (default), fifo,\n"
+          "                     lru-k, or 2q.\n"
 #endif
           );
   shutdown_power_off ();
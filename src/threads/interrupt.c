@@ -9,6 +9,9 @@
 #include "threads/thread.h"
 #include "threads/vaddr.h"
 #include "devices/timer.h"
+#ifdef VM
+#include "userprog/gdt.h"
+#endif
 
 /* Programmable Interrupt Controller (PIC) registers.
    A PC has two PICs, called the master and slave PICs, with the
@@ -386,6 +389,17 @@ intr_handler (struct intr_frame *frame)
       if (yield_on_return) 
         thread_yield (); 
     }
+
+#ifdef VM
+  /* A process that the out-of-memory killer chose exits instead
+     of returning to user mode. */
+  if (frame->cs == SEL_UCSEG && thread_current ()->oom_killed)
+    {
+      intr_enable ();
+      printf ("%s: exit(%d)\n", thread_name (), -1);
+      thread_exit ();
+    }
+#endif
 }
 
 /* Handles an unexpected interrupt with interrupt frame F.  An
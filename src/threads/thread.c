@@ -206,6 +206,9 @@ thread_create (const char *name, int priority,
 
   t->parent = thread_current();
   t->child = process_add_child(t->tid);
+#ifdef VM
+  t->rss_limit = thread_current ()->child_rss_limit;
+#endif
 
   intr_set_level (old_level);
 
@@ -476,10 +479,18 @@ init_thread (struct thread *t, const char *name, int priority)
   t->parent = NULL;
   t->child = NULL;
   t->self_file = NULL;
+  t->ring = NULL;
+  t->aio = NULL;
   // fd_id 0 and 1 is reserved for stdin and stdout.
   t->fd_id = 2;
-  list_init(&t->child_list);
+  // The children hash needs malloc(), so it is set up lazily.
+  t->children_ready = false;
+  sema_init(&t->child_exited, 0);
   list_init(&t->file_list);
+#ifdef VM
+  list_init(&t->mmap_list);
+  t->next_mapid = 0;
+#endif
 }
 
 /* Allocates a SIZE-byte frame at the top of thread T's stack and
@@ -4,6 +4,13 @@
 #include <debug.h>
 #include <list.h>
 #include <stdint.h>
+#ifdef USERPROG
+#include <hash.h>
+#include "threads/synch.h"
+#endif
+#ifdef VM
+#include "vm/page.h"
+#endif
 
 /* States in a thread's life cycle. */
 enum thread_status
@@ -100,11 +107,40 @@ struct thread
     int fd_id;
     struct thread *parent;
     struct child_process *child;
-    struct list child_list;
+    struct hash children;               /* child_process by tid. */
+    bool children_ready;                /* `children' initialized? */
+    struct semaphore child_exited;      /* Upped as each child exits. */
     struct list file_list;
 
     // File pointer to open itself to deny write.
     struct file *self_file;
+
+    // Registered batched syscall ring, if any.
+    struct syscall_ring *ring;
+
+    // Asynchronous I/O state, created on first use (aio.c).
+    struct aio_context *aio;
+#endif
+
+#ifdef VM
+    /* Owned by vm/page.c. */
+    struct hash spt;                    /* Supplemental page table. */
+    void *user_esp;                     /* User esp on entry to a syscall. */
+    struct page_stream streams[PAGE_STREAMS]; /* For read-ahead. */
+    unsigned next_stream;               /* Next stream to replace. */
+
+    /* Owned by vm/mmap.c. */
+    struct list mmap_list;              /* File mappings. */
+    int next_mapid;                     /* Next mapping id to hand out. */
+
+    /* Owned by vm/frame.c. */
+    size_t rss;                         /* Frames holding its pages. */
+    size_t rss_limit;                   /* Resident set limit, 0 for default. */
+    size_t child_rss_limit;             /* RSS_LIMIT for processes it starts. */
+    bool oom_killed;                    /* Chosen by the out-of-memory killer. */
+
+    /* Owned by vm/swap.c. */
+    size_t swap_cnt;                    /* Swap slots holding its pages. */
 #endif
 
     /* Owned by thread.c. */
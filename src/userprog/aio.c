@@ -0,0 +1,272 @@
+#include "userprog/aio.h"
+#include <debug.h>
+#include <list.h>
+#include "userprog/pagedir.h"
+#include "filesys/file.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#ifdef VM
+#include "vm/page.h"
+#endif
+
+/* Asynchronous file I/O.
+
+   aio_submit() queues a read or write on a global request queue
+   and returns at once.  A small pool of kernel worker threads
+   takes requests off the queue, transfers the data directly
+   between the file and the frames backing the user buffer, and
+   moves each finished request onto its process's completion
+   list, from which aio_collect() reaps them in batches.  With
+   virtual memory, the buffer's frames stay pinned from
+   submission until the transfer is done. */
+
+/* Number of I/O worker threads. */
+#define AIO_WORKERS 2
+
+/* Per-process asynchronous I/O state. */
+struct aio_context
+  {
+    struct list done;           /* Completed requests. */
+    int in_flight;              /* Submitted but not yet completed. */
+    int next_id;                /* Next request id to hand out. */
+    struct condition completed; /* Signaled on each completion. */
+  };
+
+/* A queued or completed request. */
+struct aio_request
+  {
+    int id;                     /* Request id, unique per process. */
+    struct aio_context *ctx;    /* Owning process's context. */
+    uint32_t *pagedir;          /* Owning process's page directory. */
+    struct file *file;          /* Private reopened file. */
+    uint8_t *buffer;            /* User buffer. */
+    unsigned size;              /* Bytes to transfer. */
+    off_t offset;               /* File offset. */
+    bool write;                 /* True for a write, false for a read. */
+    int res;                    /* Result once completed. */
+    struct list_elem elem;      /* aio_queue or aio_context `done'. */
+  };
+
+/* Requests waiting for a worker. */
+static struct list aio_queue;
+
+/* Protects aio_queue and every aio_context. */
+static struct lock aio_lock;
+
+/* Signaled when aio_queue becomes non-empty. */
+static struct condition aio_queued;
+
+extern struct lock filesys_lock;
+
+static thread_func aio_worker NO_RETURN;
+static int aio_transfer (struct aio_request *);
+
+/* Initializes asynchronous I/O and starts the worker threads. */
+void
+aio_init (void)
+{
+  int i;
+
+  list_init (&aio_queue);
+  lock_init (&aio_lock);
+  cond_init (&aio_queued);
+  for (i = 0; i < AIO_WORKERS; i++)
+    thread_create ("aio", PRI_DEFAULT, aio_worker, NULL);
+}
+
+/* Queues a transfer of SIZE bytes between user BUFFER and FILE
+   at OFFSET, a write if WRITE is true, otherwise a read.  The
+   caller must have validated BUFFER.  Returns the request id,
+   or -1 if the request could not be queued. */
+int
+aio_submit (struct file *file, void *buffer, unsigned size, off_t offset,
+            bool write)
+{
+  struct thread *cur = thread_current ();
+  struct aio_request *req;
+  int id;
+
+  if (offset < 0)
+    return -1;
+
+  if (cur->aio == NULL)
+    {
+      struct aio_context *ctx = malloc (sizeof *ctx);
+      if (ctx == NULL)
+        return -1;
+      list_init (&ctx->done);
+      ctx->in_flight = 0;
+      ctx->next_id = 0;
+      cond_init (&ctx->completed);
+      cur->aio = ctx;
+    }
+
+  req = malloc (sizeof *req);
+  if (req == NULL)
+    return -1;
+
+  /* Use a private file so that closing the descriptor doesn't
+     pull the inode out from under the worker. */
+  lock_acquire (&filesys_lock);
+  req->file = file_reopen (file);
+  lock_release (&filesys_lock);
+  if (req->file == NULL)
+    {
+      free (req);
+      return -1;
+    }
+  req->ctx = cur->aio;
+  req->pagedir = cur->pagedir;
+  req->buffer = buffer;
+  req->size = size;
+  req->offset = offset;
+  req->write = write;
+
+#ifdef VM
+  if (!page_pin_buffer (buffer, size, !write))
+    {
+      lock_acquire (&filesys_lock);
+      file_close (req->file);
+      lock_release (&filesys_lock);
+      free (req);
+      return -1;
+    }
+#endif
+
+  lock_acquire (&aio_lock);
+  id = req->id = cur->aio->next_id++;
+  cur->aio->in_flight++;
+  list_push_back (&aio_queue, &req->elem);
+  cond_signal (&aio_queued, &aio_lock);
+  lock_release (&aio_lock);
+
+  return id;
+}
+
+/* Stores up to MAX completions of the current process's
+   requests into user array EVENTS, waiting for at least one if
+   any are still in flight.  Returns the number stored. */
+int
+aio_collect (struct aio_event *events, unsigned max)
+{
+  struct aio_context *ctx = thread_current ()->aio;
+  unsigned cnt = 0;
+
+  if (ctx == NULL || max == 0)
+    return 0;
+
+  lock_acquire (&aio_lock);
+  while (list_empty (&ctx->done) && ctx->in_flight > 0)
+    cond_wait (&ctx->completed, &aio_lock);
+  while (cnt < max && !list_empty (&ctx->done))
+    {
+      struct aio_request *req = list_entry (list_pop_front (&ctx->done),
+                                            struct aio_request, elem);
+      events[cnt].id = req->id;
+      events[cnt].res = req->res;
+      cnt++;
+      free (req);
+    }
+  lock_release (&aio_lock);
+
+  return cnt;
+}
+
+/* Waits for the current process's in-flight requests, which
+   still refer to its page directory, and frees its
+   asynchronous I/O state. */
+void
+aio_exit (void)
+{
+  struct thread *cur = thread_current ();
+  struct aio_context *ctx = cur->aio;
+
+  if (ctx == NULL)
+    return;
+
+  lock_acquire (&aio_lock);
+  while (ctx->in_flight > 0)
+    cond_wait (&ctx->completed, &aio_lock);
+  lock_release (&aio_lock);
+
+  while (!list_empty (&ctx->done))
+    free (list_entry (list_pop_front (&ctx->done),
+                      struct aio_request, elem));
+  free (ctx);
+  cur->aio = NULL;
+}
+
+/* Worker thread: runs queued requests forever. */
+static void
+aio_worker (void *aux UNUSED)
+{
+  for (;;)
+    {
+      struct aio_request *req;
+
+      lock_acquire (&aio_lock);
+      while (list_empty (&aio_queue))
+        cond_wait (&aio_queued, &aio_lock);
+      req = list_entry (list_pop_front (&aio_queue),
+                        struct aio_request, elem);
+      lock_release (&aio_lock);
+
+      req->res = aio_transfer (req);
+#ifdef VM
+      page_unpin_buffer (req->pagedir, req->buffer, req->size);
+#endif
+      lock_acquire (&filesys_lock);
+      file_close (req->file);
+      lock_release (&filesys_lock);
+
+      lock_acquire (&aio_lock);
+      list_push_back (&req->ctx->done, &req->elem);
+      req->ctx->in_flight--;
+      cond_broadcast (&req->ctx->completed, &aio_lock);
+      lock_release (&aio_lock);
+    }
+}
+
+/* Performs REQ one user page at a time, reading or writing the
+   kernel mapping of each page directly.  Returns the number of
+   bytes transferred. */
+static int
+aio_transfer (struct aio_request *req)
+{
+  uint8_t *uaddr = req->buffer;
+  unsigned left = req->size;
+  off_t offset = req->offset;
+  int total = 0;
+
+  while (left > 0)
+    {
+      unsigned page_left = PGSIZE - pg_ofs (uaddr);
+      unsigned chunk = left < page_left ? left : page_left;
+      uint8_t *kaddr = pagedir_get_page (req->pagedir, uaddr);
+      off_t n;
+
+      if (kaddr == NULL)
+        break;
+      lock_acquire (&filesys_lock);
+      if (req->write)
+        n = file_write_at (req->file, kaddr, chunk, offset);
+      else
+        n = file_read_at (req->file, kaddr, chunk, offset);
+      lock_release (&filesys_lock);
+
+      /* Writing through KADDR doesn't set the user mapping's dirty
+         bit, which page replacement relies on. */
+      if (!req->write && n > 0)
+        pagedir_set_dirty (req->pagedir, uaddr, true);
+
+      total += n;
+      if (n != (off_t) chunk)
+        break;
+      uaddr += chunk;
+      offset += chunk;
+      left -= chunk;
+    }
+  return total;
+}
@@ -0,0 +1,16 @@
+#ifndef USERPROG_AIO_H
+#define USERPROG_AIO_H
+
+#include <aio.h>
+#include <stdbool.h>
+#include "filesys/off_t.h"
+
+struct file;
+
+void aio_init (void);
+int aio_submit (struct file *, void *buffer, unsigned size, off_t offset,
+                bool write);
+int aio_collect (struct aio_event *events, unsigned max);
+void aio_exit (void);
+
+#endif /* userprog/aio.h */
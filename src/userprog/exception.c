@@ -5,6 +5,9 @@
 #include "threads/interrupt.h"
 #include "threads/thread.h"
 #include "threads/vaddr.h"
+#ifdef VM
+#include "vm/page.h"
+#endif
 
 /* Number of page faults processed. */
 static long long page_fault_cnt;
@@ -151,6 +154,20 @@ page_fault (struct intr_frame *f)
   write = (f->error_code & PF_W) != 0;
   user = (f->error_code & PF_U) != 0;
 
+#ifdef VM
+  /* A page the process owns but hasn't touched yet, a write to
+     the shared zero page, or the stack growing, from user code or
+     from the kernel on its behalf.  The CPU only saves esp on a
+     switch from user mode, so for a fault in the kernel use the
+     esp saved on entry to the system call. */
+  if (is_user_vaddr (fault_addr)
+      && (page_load (pg_round_down (fault_addr), write)
+          || (not_present
+              && page_grow_stack (fault_addr, user
+                                  ? f->esp : thread_current ()->user_esp))))
+    return;
+#endif
+
   if(!not_present || !fault_addr || !is_user_vaddr(fault_addr)) exit(-1);
 
   /* To implement virtual memory, delete the rest of the function
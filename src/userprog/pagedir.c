@@ -7,6 +7,7 @@
 #include "threads/palloc.h"
 
 static uint32_t *active_pd (void);
+static void load_pd (uint32_t *);
 static void invalidate_pagedir (uint32_t *);
 
 /* Creates a new page directory that has mappings for kernel
@@ -215,13 +216,24 @@ pagedir_set_accessed (uint32_t *pd, const void *vpage, bool accessed)
 }
 
 /* Loads page directory PD into the CPU's page directory base
-   register. */
+   register, unless it is already loaded.  Loading it flushes
+   the TLB of every mapping but the kernel's global ones, so it
+   is not done needlessly. */
 void
 pagedir_activate (uint32_t *pd) 
 {
   if (pd == NULL)
     pd = init_page_dir;
 
+  if (pd != active_pd ())
+    load_pd (pd);
+}
+
+/* Loads page directory PD into the CPU's page directory base
+   register. */
+static void
+load_pd (uint32_t *pd) 
+{
   /* Store the physical address of the page directory into CR3
      aka PDBR (page directory base register).  This activates our
      new page tables immediately.  See [IA32-v2a] "MOV--Move
@@ -256,8 +268,9 @@ invalidate_pagedir (uint32_t *pd)
 {
   if (active_pd () == pd) 
     {
-      /* Re-activating PD clears the TLB.  See [IA32-v3a] 3.12
+      /* Re-loading PD clears the TLB of all but global entries,
+         which only map kernel memory.  See [IA32-v3a] 3.12
          "Translation Lookaside Buffers (TLBs)". */
-      pagedir_activate (pd);
+      load_pd (pd);
     } 
 }
@@ -0,0 +1,174 @@
+#include "userprog/pipe.h"
+#include <debug.h>
+#include <stdint.h>
+#include <string.h>
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+
+/* Size of a pipe's ring buffer, in bytes.  Must be a power of
+   two. */
+#define PIPE_SIZE PGSIZE
+
+/* An in-kernel pipe: a one-page ring buffer with blocking
+   readers and writers.
+
+   HEAD and TAIL run freely, so HEAD - TAIL is always the number
+   of buffered bytes.  Waiters are only woken on the transitions
+   that can unblock them: readers when the buffer goes from empty
+   to non-empty, writers when it goes from full to non-full, and
+   either side when the other side's last end is closed. */
+struct pipe
+  {
+    struct lock lock;           /* Protects all of the below. */
+    struct condition not_empty; /* Data arrived or writers gone. */
+    struct condition not_full;  /* Space freed or readers gone. */
+    uint8_t *buf;               /* PIPE_SIZE-byte ring buffer. */
+    unsigned head;              /* Total bytes ever written. */
+    unsigned tail;              /* Total bytes ever read. */
+    int readers;                /* Open read ends. */
+    int writers;                /* Open write ends. */
+  };
+
+/* Creates a pipe with one open read end and one open write end.
+   Returns the new pipe, or a null pointer if memory allocation
+   fails. */
+struct pipe *
+pipe_create (void) 
+{
+  struct pipe *p = malloc (sizeof *p);
+  if (p == NULL)
+    return NULL;
+  p->buf = palloc_get_page (0);
+  if (p->buf == NULL)
+    {
+      free (p);
+      return NULL;
+    }
+  lock_init (&p->lock);
+  cond_init (&p->not_empty);
+  cond_init (&p->not_full);
+  p->head = p->tail = 0;
+  p->readers = p->writers = 1;
+  return p;
+}
+
+/* Reads up to SIZE bytes from P into BUFFER.  Waits until at
+   least one byte is available, unless every write end has been
+   closed.  Returns the number of bytes read, which is 0 at end
+   of file. */
+int
+pipe_read (struct pipe *p, void *buffer_, unsigned size) 
+{
+  uint8_t *buffer = buffer_;
+  unsigned cnt, ofs, chunk;
+  bool was_full;
+
+  lock_acquire (&p->lock);
+  while (p->head == p->tail && p->writers > 0 && size > 0)
+    cond_wait (&p->not_empty, &p->lock);
+
+  was_full = p->head - p->tail == PIPE_SIZE;
+  cnt = p->head - p->tail;
+  if (cnt > size)
+    cnt = size;
+
+  /* Copy out in up to two pieces, around the end of the ring. */
+  ofs = p->tail % PIPE_SIZE;
+  chunk = cnt < PIPE_SIZE - ofs ? cnt : PIPE_SIZE - ofs;
+  memcpy (buffer, p->buf + ofs, chunk);
+  memcpy (buffer + chunk, p->buf, cnt - chunk);
+  p->tail += cnt;
+
+  if (was_full && cnt > 0)
+    cond_broadcast (&p->not_full, &p->lock);
+  lock_release (&p->lock);
+
+  return cnt;
+}
+
+/* Writes SIZE bytes from BUFFER into P, waiting for room as
+   necessary.  Returns the number of bytes written, which is
+   less than SIZE only if every read end has been closed, or -1
+   if none could be written for that reason. */
+int
+pipe_write (struct pipe *p, const void *buffer_, unsigned size) 
+{
+  const uint8_t *buffer = buffer_;
+  unsigned done = 0;
+
+  lock_acquire (&p->lock);
+  while (done < size)
+    {
+      unsigned cnt, ofs, chunk;
+      bool was_empty;
+
+      while (p->head - p->tail == PIPE_SIZE && p->readers > 0)
+        cond_wait (&p->not_full, &p->lock);
+      if (p->readers == 0)
+        break;
+
+      was_empty = p->head == p->tail;
+      cnt = PIPE_SIZE - (p->head - p->tail);
+      if (cnt > size - done)
+        cnt = size - done;
+
+      /* Copy in, in up to two pieces. */
+      ofs = p->head % PIPE_SIZE;
+      chunk = cnt < PIPE_SIZE - ofs ? cnt : PIPE_SIZE - ofs;
+      memcpy (p->buf + ofs, buffer + done, chunk);
+      memcpy (p->buf, buffer + done + chunk, cnt - chunk);
+      p->head += cnt;
+      done += cnt;
+
+      if (was_empty)
+        cond_broadcast (&p->not_empty, &p->lock);
+    }
+  lock_release (&p->lock);
+
+  return done > 0 || size == 0 ? (int) done : -1;
+}
+
+/* Opens another read end of P if WRITE_END is false, or another
+   write end if it is true. */
+void
+pipe_dup (struct pipe *p, bool write_end) 
+{
+  lock_acquire (&p->lock);
+  if (write_end)
+    p->writers++;
+  else
+    p->readers++;
+  lock_release (&p->lock);
+}
+
+/* Closes a read end of P if WRITE_END is false, or a write end
+   if it is true, and frees P once both sides are closed. */
+void
+pipe_close (struct pipe *p, bool write_end) 
+{
+  bool destroy;
+
+  lock_acquire (&p->lock);
+  if (write_end)
+    {
+      ASSERT (p->writers > 0);
+      if (--p->writers == 0)
+        cond_broadcast (&p->not_empty, &p->lock);
+    }
+  else
+    {
+      ASSERT (p->readers > 0);
+      if (--p->readers == 0)
+        cond_broadcast (&p->not_full, &p->lock);
+    }
+  destroy = p->readers == 0 && p->writers == 0;
+  lock_release (&p->lock);
+
+  if (destroy)
+    {
+      palloc_free_page (p->buf);
+      free (p);
+    }
+}
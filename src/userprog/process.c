@@ -5,8 +5,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "userprog/aio.h"
 #include "userprog/gdt.h"
 #include "userprog/pagedir.h"
+#include "userprog/pipe.h"
+#include "userprog/shared-data.h"
 #include "userprog/tss.h"
 #include "userprog/syscall.h"
 #include "filesys/directory.h"
@@ -19,11 +22,27 @@
 #include "threads/palloc.h"
 #include "threads/thread.h"
 #include "threads/vaddr.h"
+#ifdef VM
+#include "vm/mmap.h"
+#include "vm/page.h"
+#endif
 
 
 extern struct lock filesys_lock;
 
+/* Maximum number of pages that a command line, and so the
+   argument area at the top of a new process's stack, may span. */
+#define ARG_PAGES_MAX 8
+
 static thread_func start_process NO_RETURN;
+static void inherit_std_fds (void);
+static struct file_descriptor *lookup_fd (struct thread *t, int fd);
+static void close_fd (struct file_descriptor *file_desc);
+static void publish_exit (struct thread *cur);
+static void release_child (struct child_process *child);
+static hash_action_func release_child_elem;
+static hash_hash_func child_hash;
+static hash_less_func child_less;
 static bool load (const char *cmdline, void (**eip) (void), void **esp);
 
 /* Starts a new thread running a user program loaded from
@@ -34,30 +53,34 @@ tid_t
 process_execute (const char *file_name) 
 {
   char *fn_copy;
+  char name[sizeof ((struct thread *) 0)->name];
+  size_t len, name_len, page_cnt;
   tid_t tid;
 
+  /* The command line may span several pages, up to the size of
+     the argument area that setup_stack() is willing to build. */
+  len = strnlen (file_name, ARG_PAGES_MAX * PGSIZE);
+  if (len == ARG_PAGES_MAX * PGSIZE)
+    return TID_ERROR;
+  page_cnt = DIV_ROUND_UP (len + 1, PGSIZE);
+
   /* Make a copy of FILE_NAME.
      Otherwise there's a race between the caller and load(). */
-  fn_copy = palloc_get_page (0);
+  fn_copy = palloc_get_multiple (0, page_cnt);
   if (fn_copy == NULL)
     return TID_ERROR;
-  strlcpy (fn_copy, file_name, PGSIZE);
-
-  char *true_name;
-  int name_size = 0;
-  while(*(file_name + name_size) != ' ' && *(file_name + name_size) != '\0')
-    name_size++;
-  name_size++;
-  true_name = malloc(name_size*(sizeof (char *)));
-  if(!true_name) return -1;
-  memcpy(true_name, file_name, name_size);
-  true_name[name_size-1] = '\0';
+  memcpy (fn_copy, file_name, len + 1);
+
+  /* Name the thread after the program, i.e. the first word. */
+  file_name += strspn (file_name, " ");
+  name_len = strcspn (file_name, " ");
+  strlcpy (name, file_name,
+           name_len < sizeof name ? name_len + 1 : sizeof name);
 
   /* Create a new thread to execute FILE_NAME. */
-  tid = thread_create (true_name, PRI_DEFAULT, start_process, fn_copy);
-  free(true_name);
+  tid = thread_create (name, PRI_DEFAULT, start_process, fn_copy);
   if (tid == TID_ERROR)
-    palloc_free_page (fn_copy); 
+    palloc_free_multiple (fn_copy, page_cnt); 
   return tid;
 }
 
@@ -75,13 +98,15 @@ start_process (void *file_name_)
   if_.gs = if_.fs = if_.es = if_.ds = if_.ss = SEL_UDSEG;
   if_.cs = SEL_UCSEG;
   if_.eflags = FLAG_IF | FLAG_MBS;
+  inherit_std_fds ();
   success = load (file_name, &if_.eip, &if_.esp);
 
   thread_current()->child->load_status = success ? 0 : 1;
   sema_up(&thread_current()->child->load_sema);
 
   /* If load failed, quit. */
-  palloc_free_page (file_name);
+  palloc_free_multiple (file_name, DIV_ROUND_UP (strlen (file_name) + 1,
+                                                 PGSIZE));
   if (!success) 
     thread_exit ();
 
@@ -102,8 +127,9 @@ start_process (void *file_name_)
    been successfully called for the given TID, returns -1
    immediately, without waiting.
 
-   This function will be implemented in pro 2-2.  For now, it
-   does nothing. */
+   The child publishes its status before tearing down its
+   address space, so this returns as soon as the status is
+   known, and the child's record is freed right away. */
 int
 process_wait (tid_t child_tid) 
 {
@@ -114,7 +140,49 @@ process_wait (tid_t child_tid)
   // Wait for its exit.
   if(!child->exit_status)
     sema_down(&child->exit_sema);
-  return child->exit_retval;
+  int retval = child->exit_retval;
+  process_remove_child(child_tid);
+  return retval;
+}
+
+/* Waits for any child process that nobody is waiting for yet to
+   die, stores its exit status into *STATUS, and returns its tid.
+   Returns -1 immediately if there is no such child. */
+tid_t
+process_wait_any (int *status) 
+{
+  struct thread *cur = thread_current ();
+  if (!cur->children_ready)
+    return -1;
+  for (;;)
+    {
+      struct hash_iterator i;
+      bool alive = false;
+
+      hash_first (&i, &cur->children);
+      while (hash_next (&i))
+        {
+          struct child_process *c = hash_entry (hash_cur (&i),
+                                                struct child_process, elem);
+          if (c->waiting)
+            continue;
+          if (c->exit_status)
+            {
+              tid_t tid = c->tid;
+              *status = c->exit_retval;
+              process_remove_child (tid);
+              return tid;
+            }
+          alive = true;
+        }
+      if (!alive)
+        return -1;
+
+      /* Every child's exit ups this, including children reaped
+         by process_wait(), so after waking we may find nothing
+         and go back to sleep. */
+      sema_down (&cur->child_exited);
+    }
 }
 
 /* Free the current process's resources. */
@@ -122,7 +190,19 @@ void
 process_exit (void)
 {
   struct thread *cur = thread_current ();
+  aio_exit ();
+  lock_acquire(&filesys_lock);
   file_close(cur->self_file);
+  lock_release(&filesys_lock);
+  cur->self_file = NULL;
+#ifdef VM
+  /* Write mapped files back before the parent can look at them. */
+  mmap_destroy ();
+#endif
+
+  /* Let a waiting parent go before the expensive teardown. */
+  publish_exit (cur);
+
   process_remove_child_all();
   process_remove_fd_all();
   uint32_t *pd;
@@ -141,9 +221,37 @@ process_exit (void)
          that's been freed (and cleared). */
       cur->pagedir = NULL;
       pagedir_activate (NULL);
+#ifdef VM
+      sup_table_destroy (&cur->spt, pd);
+#endif
+      shared_data_unmap (pd);
       pagedir_destroy (pd);
     }
-  sema_up(&cur->child->exit_sema);
+}
+
+/* Marks CUR's child_process record as exited and wakes up its
+   parent, or frees the record if the parent is gone.  CUR must
+   not touch the record afterward: the parent may free it. */
+static void
+publish_exit (struct thread *cur) 
+{
+  struct child_process *child = cur->child;
+  enum intr_level old_level;
+
+  if (child == NULL)
+    return;
+  cur->child = NULL;
+
+  old_level = intr_disable ();
+  if (child->orphaned)
+    free (child);
+  else
+    {
+      child->exit_status = 1;
+      sema_up (&child->exit_sema);
+      sema_up (&cur->parent->child_exited);
+    }
+  intr_set_level (old_level);
 }
 
 /* Sets up the CPU for running user code in the current
@@ -154,8 +262,17 @@ process_activate (void)
 {
   struct thread *t = thread_current ();
 
-  /* Activate thread's page tables. */
-  pagedir_activate (t->pagedir);
+  /* Activate thread's page tables.  A thread without any keeps
+     running in whichever ones are active: it only touches kernel
+     memory, which every page directory maps alike, and skipping
+     the switch keeps the TLB warm for the process it came from
+     and will likely go back to. */
+  if (t->pagedir != NULL)
+    pagedir_activate (t->pagedir);
+
+  /* Tell the process who it is. */
+  if (t->pagedir != NULL)
+    shared_data_activate (t->tid);
 
   /* Set thread's kernel stack for use in processing
      interrupts. */
@@ -225,18 +342,19 @@ struct Elf32_Phdr
 #define PF_W 2          /* Writable. */
 #define PF_R 4          /* Readable. */
 
-static bool setup_stack (void **esp, char *file_name, char *save_ptr);
+static bool setup_stack (void **esp, const char *cmdline, char **file_name);
 static bool validate_segment (const struct Elf32_Phdr *, struct file *);
 static bool load_segment (struct file *file, off_t ofs, uint8_t *upage,
                           uint32_t read_bytes, uint32_t zero_bytes,
                           bool writable);
 
-/* Loads an ELF executable from FILE_NAME into the current thread.
-   Stores the executable's entry point into *EIP
+/* Loads the ELF executable named by the first word of CMDLINE
+   into the current thread, passing it the words of CMDLINE as
+   arguments.  Stores the executable's entry point into *EIP
    and its initial stack pointer into *ESP.
    Returns true if successful, false otherwise. */
 bool
-load (const char *file_args, void (**eip) (void), void **esp) 
+load (const char *cmdline, void (**eip) (void), void **esp) 
 {
   struct thread *t = thread_current ();
   struct Elf32_Ehdr ehdr;
@@ -245,21 +363,43 @@ load (const char *file_args, void (**eip) (void), void **esp)
   bool success = false;
   int i;
 
-  char *file_name, *save_ptr;
-  file_name = strtok_r(file_args, " ", &save_ptr);
+  char *file_name;
+  /* FILE_NAME lives on the new user stack, which may be paged out
+     and must not be faulted on with the file system lock held.
+     One byte longer than a file name may be, so that a longer
+     name still fails to open. */
+  char exe_name[NAME_MAX + 2];
 
   /* Allocate and activate page directory. */
   t->pagedir = pagedir_create ();
   if (t->pagedir == NULL) 
     goto done;
+#ifdef VM
+  /* process_exit() tears down the supplemental page table of any
+     process that has a page directory. */
+  if (!sup_table_init (&t->spt))
+    {
+      pagedir_destroy (t->pagedir);
+      t->pagedir = NULL;
+      goto done;
+    }
+#endif
+  if (!shared_data_map (t->pagedir))
+    goto done;
   process_activate ();
 
+  /* Set up stack.  This also splits CMDLINE into words, the
+     first of which names the executable. */
+  if (!setup_stack (esp, cmdline, &file_name))
+    goto done;
+  strlcpy (exe_name, file_name, sizeof exe_name);
+
   /* Open executable file. */
   lock_acquire(&filesys_lock);
-  file = filesys_open (file_name);
+  file = filesys_open (exe_name);
   if (file == NULL) 
     {
-      printf ("load: %s: open failed\n", file_name);
+      printf ("load: %s: open failed\n", exe_name);
       goto done; 
     }
 
@@ -274,7 +414,7 @@ load (const char *file_args, void (**eip) (void), void **esp)
       || ehdr.e_phentsize != sizeof (struct Elf32_Phdr)
       || ehdr.e_phnum > 1024) 
     {
-      printf ("load: %s: error loading executable\n", file_name);
+      printf ("load: %s: error loading executable\n", exe_name);
       goto done; 
     }
 
@@ -337,10 +477,6 @@ load (const char *file_args, void (**eip) (void), void **esp)
         }
     }
 
-  /* Set up stack. */
-  if (!setup_stack (esp, file_name, save_ptr))
-    goto done;
-
   /* Start address. */
   *eip = (void (*) (void)) ehdr.e_entry;
 
@@ -348,14 +484,17 @@ load (const char *file_args, void (**eip) (void), void **esp)
 
  done:
   /* We arrive here whether the load is successful or not. */
-  lock_release(&filesys_lock);
+  if (lock_held_by_current_thread (&filesys_lock))
+    lock_release (&filesys_lock);
   t->self_file = file;
   return success;
 }
 
 /* load() helpers. */
 
+#ifndef VM
 static bool install_page (void *upage, void *kpage, bool writable);
+#endif
 
 /* Checks whether PHDR describes a valid, loadable segment in
    FILE and returns true if so, false otherwise. */
@@ -424,7 +563,9 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
   ASSERT (pg_ofs (upage) == 0);
   ASSERT (ofs % PGSIZE == 0);
 
+#ifndef VM
   file_seek (file, ofs);
+#endif
   while (read_bytes > 0 || zero_bytes > 0) 
     {
       /* Calculate how to fill this page.
@@ -433,6 +574,13 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
       size_t page_read_bytes = read_bytes < PGSIZE ? read_bytes : PGSIZE;
       size_t page_zero_bytes = PGSIZE - page_read_bytes;
 
+#ifdef VM
+      /* Only record where the page comes from; it is read in on
+         first touch. */
+      if (!page_add_file (upage, file, ofs, page_read_bytes, writable))
+        return false;
+      ofs += page_read_bytes;
+#else
       /* Get a page of memory. */
       uint8_t *kpage = palloc_get_page (PAL_USER);
       if (kpage == NULL)
@@ -452,6 +600,7 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
           palloc_free_page (kpage);
           return false; 
         }
+#endif
 
       /* Advance. */
       read_bytes -= page_read_bytes;
@@ -461,70 +610,90 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
   return true;
 }
 
-/* Create a minimal stack by mapping a zeroed page at the top of
-   user virtual memory. */
+/* Maps zeroed, writable pages below *BOTTOM, the lowest stack
+   page mapped so far, until UADDR is covered, and updates
+   *BOTTOM accordingly. */
+static bool
+map_stack_pages (uint8_t **bottom, const void *uaddr)
+{
+  while (*bottom > (uint8_t *) pg_round_down (uaddr))
+    {
+      uint8_t *upage = *bottom - PGSIZE;
+#ifdef VM
+      if (!page_add_zero (upage, true) || !page_load (upage, true))
+        return false;
+#else
+      uint8_t *kpage = palloc_get_page (PAL_USER | PAL_ZERO);
+      if (kpage == NULL)
+        return false;
+      if (!install_page (upage, kpage, true))
+        {
+          palloc_free_page (kpage);
+          return false;
+        }
+#endif
+      *bottom = upage;
+    }
+  return true;
+}
+
+/* Creates the initial stack at the top of user virtual memory
+   and lays out the arguments of CMDLINE on it, 80x86 calling
+   convention style.  Each space-separated word is copied
+   straight onto the stack, so no temporary argv is needed, and
+   as many pages are mapped as the arguments require.  Stores a
+   pointer to argv[0] into *FILE_NAME. */
 static bool
-setup_stack (void **esp, char *args, char *save_ptr) 
+setup_stack (void **esp, const char *cmdline, char **file_name) 
 {
-  uint8_t *kpage;
+  uint8_t *bottom = PHYS_BASE;
+  char *strings = (char *) PHYS_BASE - (strlen (cmdline) + 1);
+  char *dst = strings;
+  const char *src = cmdline;
+  char **argv;
+  uint32_t *sp;
+  int argc = 0;
+  int i;
 
-  kpage = palloc_get_page (PAL_USER | PAL_ZERO);
-  if(kpage == NULL) return false;
-  if(!install_page (((uint8_t *) PHYS_BASE) - PGSIZE, kpage, true))
-  {
-    palloc_free_page (kpage);
+  /* Words, NUL-terminated, from the top of the stack down. */
+  if (!map_stack_pages (&bottom, strings))
     return false;
-  }
-  *esp = PHYS_BASE;
-  /* Pushing args into stack */
-  int argc = 0, argv_size = 1;
-  char **argv = malloc(sizeof (char *));
-  if(!argv) return false;
-  while(args != NULL)
-  {
-    *esp -= strlen(args) + 1;
-    memcpy(*esp, args, strlen(args) + 1);
-    argv[argc++] = *esp;
-    if(argc >= argv_size)
-    {
-      argv_size *= 2;
-      char **tmp = realloc(argv, argv_size * (sizeof (char *)));
-      if(!tmp)
+  while (*src != '\0')
+    if (*src == ' ')
+      src++;
+    else
       {
-        free(argv);
-        return false;
+        while (*src != ' ' && *src != '\0')
+          *dst++ = *src++;
+        *dst++ = '\0';
+        argc++;
       }
-      argv = tmp;
+  if (argc == 0)
+    return false;
+
+  /* Below the word-aligned strings: argv[], then argv, argc and
+     a fake return address. */
+  argv = (char **) ROUND_DOWN ((uintptr_t) strings, sizeof (char *));
+  argv -= argc + 1;
+  sp = (uint32_t *) argv - 3;
+  if (!map_stack_pages (&bottom, sp))
+    return false;
+  for (dst = strings, i = 0; i < argc; i++)
+    {
+      argv[i] = dst;
+      dst += strlen (dst) + 1;
     }
-    args = strtok_r (NULL, " ", &save_ptr);
-  }
-  argv[argc] = 0;
-  // Word align access
-  int leftover = (size_t) *esp % 4;
-  *esp -= leftover;
-  memcpy(*esp, &argv[argc], leftover);
+  argv[argc] = NULL;
+  sp[0] = 0;
+  sp[1] = argc;
+  sp[2] = (uint32_t) argv;
 
-  int i;
-  for(i=argc; i>=0; i--)
-  {
-    *esp -= sizeof (char *);
-    memcpy(*esp, &argv[i], sizeof (char *));
-  }
-  // Pointer to argv
-  char *argv_addr;
-  argv_addr = *esp;
-  *esp -= sizeof (char **);
-  memcpy(*esp, &argv_addr, sizeof (char **));
-  // argc
-  *esp -= sizeof(int);
-  memcpy(*esp, &argc, sizeof(int));
-  // Return address
-  *esp -= sizeof (char *);
-  memcpy(*esp, &argv[argc], sizeof (char *));
-  free(argv);
+  *esp = sp;
+  *file_name = strings;
   return true;
 }
 
+#ifndef VM
 /* Adds a mapping from user virtual address UPAGE to kernel
    virtual address KPAGE to the page table.
    If WRITABLE is true, the user process may modify the page;
@@ -544,67 +713,93 @@ install_page (void *upage, void *kpage, bool writable)
   return (pagedir_get_page (t->pagedir, upage) == NULL
           && pagedir_set_page (t->pagedir, upage, kpage, writable));
 }
+#endif
 
 // Add thread with tid = child_tid to the current thread's child
-// list, and return the corresponding child_process.
+// table, and return the corresponding child_process.
 struct child_process *process_add_child(int child_tid)
 {
   if(child_tid == -1) return NULL;
+  struct thread *cur = thread_current();
+  if(!cur->children_ready)
+  {
+    if(!hash_init(&cur->children, child_hash, child_less, NULL))
+      return NULL;
+    cur->children_ready = true;
+  }
   struct child_process *child = malloc(sizeof (struct child_process));
   if(!child) return NULL;
   child->tid = child_tid;
   child->load_status = -1;
   child->exit_status = 0;
-  child->exit_retval = 0;
+  // Killed processes never call exit(), so default to -1.
+  child->exit_retval = -1;
   child->waiting = false;
+  child->orphaned = false;
   sema_init(&child->load_sema, 0);
   sema_init(&child->exit_sema, 0);
-  list_push_back(&thread_current()->child_list, &child->elem);
+  hash_insert(&cur->children, &child->elem);
   return child;
 }
 
 // Get child_process with tid = child_tid
 struct child_process *process_get_child(int child_tid)
 {
-  if(child_tid == -1) return NULL;
-  struct list_elem *e;
-  struct list *child_lst = &thread_current()->child_list;
-  for(e=list_begin(child_lst); e != list_end(child_lst); e = list_next(e))
-  {
-    struct child_process *c = list_entry (e, struct child_process, elem);
-    if(c->tid == child_tid) return c;
-  }
-  return NULL;
+  struct thread *cur = thread_current();
+  if(child_tid == -1 || !cur->children_ready) return NULL;
+  struct child_process key;
+  key.tid = child_tid;
+  struct hash_elem *e = hash_find(&cur->children, &key.elem);
+  return e != NULL ? hash_entry(e, struct child_process, elem) : NULL;
 }
 
 // Remove child_process with tid = child_tid
 void process_remove_child(int child_tid)
 {
-  struct list_elem *e;
-  struct list *child_lst = &thread_current()->child_list;
-  for(e=list_begin(child_lst); e != list_end(child_lst); e = list_next(e))
+  struct child_process *c = process_get_child(child_tid);
+  if(c)
   {
-    struct child_process *c = list_entry (e, struct child_process, elem);
-    if(c->tid == child_tid)
-    {
-      list_remove(e);
-      free(c);
-      return;
-    }
+    hash_delete(&thread_current()->children, &c->elem);
+    release_child(c);
   }
 }
 
 // Remove all child of current process
-void process_remove_child_all()
+void process_remove_child_all(void)
 {
-  struct list_elem *e;
-  struct list *child_lst = &thread_current()->child_list;
-  for(e=list_begin(child_lst); e != list_end(child_lst);)
-  {
-    struct child_process *c = list_entry (e, struct child_process, elem);
-    e = list_remove(e);
-    free(c);
-  }
+  struct thread *cur = thread_current();
+  if(!cur->children_ready) return;
+  hash_destroy(&cur->children, release_child_elem);
+  cur->children_ready = false;
+}
+
+// Free CHILD, which has been removed from its parent's table, or
+// leave it for the child to free on exit if it is still running.
+static void release_child(struct child_process *child)
+{
+  enum intr_level old_level = intr_disable();
+  if(child->exit_status)
+    free(child);
+  else
+    child->orphaned = true;
+  intr_set_level(old_level);
+}
+
+static void release_child_elem(struct hash_elem *e, void *aux UNUSED)
+{
+  release_child(hash_entry(e, struct child_process, elem));
+}
+
+static unsigned child_hash(const struct hash_elem *e, void *aux UNUSED)
+{
+  return hash_int(hash_entry(e, struct child_process, elem)->tid);
+}
+
+static bool child_less(const struct hash_elem *a, const struct hash_elem *b,
+                       void *aux UNUSED)
+{
+  return hash_entry(a, struct child_process, elem)->tid
+         < hash_entry(b, struct child_process, elem)->tid;
 }
 
 struct file_descriptor *process_add_fd(struct file *file)
@@ -614,15 +809,66 @@ struct file_descriptor *process_add_fd(struct file *file)
   struct thread *cur = thread_current();
   file_desc->fd = cur->fd_id++;
   file_desc->file = file;
+  file_desc->pipe = NULL;
+  file_desc->write_end = false;
+  list_push_back(&cur->file_list, &file_desc->elem);
+  return file_desc;
+}
+
+// Add one end of PIPE to the current process's fd table.
+struct file_descriptor *process_add_pipe(struct pipe *pipe, bool write_end)
+{
+  struct file_descriptor *file_desc = malloc(sizeof(struct file_descriptor));
+  if(!file_desc) return NULL;
+  struct thread *cur = thread_current();
+  file_desc->fd = cur->fd_id++;
+  file_desc->file = NULL;
+  file_desc->pipe = pipe;
+  file_desc->write_end = write_end;
   list_push_back(&cur->file_list, &file_desc->elem);
   return file_desc;
 }
 
+// Add a copy of SRC, which may belong to another process, to the
+// current process's fd table as FD.  FD must not be open.  A
+// pipe end gains another reference; a file is reopened at the
+// same position, but its position is not shared afterwards.
+struct file_descriptor *process_dup_fd(struct file_descriptor *src, int fd)
+{
+  struct file_descriptor *file_desc = malloc(sizeof(struct file_descriptor));
+  if(!file_desc) return NULL;
+  file_desc->fd = fd;
+  file_desc->file = NULL;
+  file_desc->pipe = src->pipe;
+  file_desc->write_end = src->write_end;
+  if(src->pipe)
+    pipe_dup(src->pipe, src->write_end);
+  else
+  {
+    lock_acquire(&filesys_lock);
+    file_desc->file = file_reopen(src->file);
+    if(file_desc->file)
+      file_seek(file_desc->file, file_tell(src->file));
+    lock_release(&filesys_lock);
+    if(!file_desc->file)
+    {
+      free(file_desc);
+      return NULL;
+    }
+  }
+  list_push_back(&thread_current()->file_list, &file_desc->elem);
+  return file_desc;
+}
+
 struct file_descriptor *process_get_fd(int fd)
+{
+  return lookup_fd(thread_current(), fd);
+}
+
+static struct file_descriptor *lookup_fd(struct thread *t, int fd)
 {
   struct list_elem *e;
-  struct thread *cur = thread_current();
-  for(e=list_begin(&cur->file_list); e!=list_end(&cur->file_list); e = list_next(e))
+  for(e=list_begin(&t->file_list); e!=list_end(&t->file_list); e = list_next(e))
   {
     struct file_descriptor *file_desc = list_entry(e, struct file_descriptor, elem);
     if(file_desc->fd == fd) return file_desc;
@@ -630,23 +876,43 @@ struct file_descriptor *process_get_fd(int fd)
   return NULL;
 }
 
+// Give the new process its own copies of its parent's stdin and
+// stdout if the parent has redirected them, e.g. to a pipe.  The
+// parent is blocked in exec() until we have loaded, so its fd
+// table can't change under us.
+static void inherit_std_fds(void)
+{
+  struct thread *parent = thread_current()->parent;
+  int fd;
+  if(!parent) return;
+  for(fd = STDIN_FILENO; fd <= STDOUT_FILENO; fd++)
+  {
+    struct file_descriptor *file_desc = lookup_fd(parent, fd);
+    if(file_desc) process_dup_fd(file_desc, fd);
+  }
+}
+
+// Close the file or pipe end behind FILE_DESC and free it.
+static void close_fd(struct file_descriptor *file_desc)
+{
+  if(file_desc->pipe)
+    pipe_close(file_desc->pipe, file_desc->write_end);
+  else
+  {
+    lock_acquire(&filesys_lock);
+    if(file_desc->file) file_close(file_desc->file);
+    lock_release(&filesys_lock);
+  }
+  free(file_desc);
+}
+
 void process_remove_fd(int fd)
 {
-  struct list_elem *e;
-  struct thread *cur = thread_current();
-  for(e=list_begin(&cur->file_list); e!=list_end(&cur->file_list); e = list_next(e))
+  struct file_descriptor *file_desc = process_get_fd(fd);
+  if(file_desc)
   {
-    struct file_descriptor *file_desc = list_entry(e, struct file_descriptor, elem);
-    if(file_desc->fd == fd)
-    {
-      list_remove(e);
-      struct file *f = file_desc->file;
-      lock_acquire(&filesys_lock);
-      if(f) file_close(f);
-      lock_release(&filesys_lock);
-      free(file_desc);
-      return;
-    }
+    list_remove(&file_desc->elem);
+    close_fd(file_desc);
   }
 }
 
@@ -658,10 +924,6 @@ void process_remove_fd_all()
   {
     struct file_descriptor *file_desc = list_entry(e, struct file_descriptor, elem);
     e = list_remove(e);
-    struct file *f = file_desc->file;
-    lock_acquire(&filesys_lock);
-    if(f) file_close(f);
-    lock_release(&filesys_lock);
-    free(file_desc);
+    close_fd(file_desc);
   }
-}
\ No newline at end of file
+}
@@ -12,29 +12,35 @@ struct child_process
 	int exit_status;
 	int exit_retval;
 	bool waiting;
+	bool orphaned;								/* Parent gone: child frees this on exit. */
 	struct semaphore load_sema;
 	struct semaphore exit_sema;
-	struct list_elem elem;
+	struct hash_elem elem;				/* Element in parent's `children' hash. */
 };
 
 struct file_descriptor
 {
 	int fd;
-	struct file *file;
+	struct file *file;						/* Open file, or null for a pipe end. */
+	struct pipe *pipe;						/* Pipe, or null for a file. */
+	bool write_end;								/* For a pipe: write end or read end? */
 	struct list_elem elem;
 };
 
 tid_t process_execute (const char *file_name);
 int process_wait (tid_t);
+tid_t process_wait_any (int *status);
 void process_exit (void);
 void process_activate (void);
 
 struct child_process *process_add_child(int child_tid);
 struct child_process *process_get_child(int child_tid);
 void process_remove_child(int child_tid);
-void process_remove_child();
+void process_remove_child_all(void);
 
 struct file_descriptor *process_add_fd(struct file *file);
+struct file_descriptor *process_add_pipe(struct pipe *pipe, bool write_end);
+struct file_descriptor *process_dup_fd(struct file_descriptor *src, int fd);
 struct file_descriptor *process_get_fd(int fd);
 void process_remove_fd(int fd);
 void process_remove_fd_all();
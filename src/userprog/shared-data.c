@@ -0,0 +1,64 @@
+#include "userprog/shared-data.h"
+#include <debug.h>
+#include "userprog/pagedir.h"
+#include "devices/rtc.h"
+#include "devices/timer.h"
+#include "threads/interrupt.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+
+/* The shared data page, in the kernel pool.  There is only one:
+   every process maps the same frame read-only. */
+static struct shared_data *shared_data;
+
+/* Allocates and initializes the shared data page. */
+void
+shared_data_init (void) 
+{
+  shared_data = palloc_get_page (PAL_ASSERT | PAL_ZERO);
+  shared_data->boot_time = rtc_get_time ();
+}
+
+/* Publishes the current time.  Called by the timer interrupt
+   handler on every tick. */
+void
+shared_data_tick (int64_t ticks) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  if (shared_data == NULL)
+    return;
+
+  shared_data->seq++;
+  barrier ();
+  shared_data->ticks = ticks;
+  shared_data->time_ns = ticks * (1000000000 / TIMER_FREQ);
+  barrier ();
+  shared_data->seq++;
+}
+
+/* Publishes PID as the running process's id.  Called on every
+   switch to a user process. */
+void
+shared_data_activate (int pid) 
+{
+  if (shared_data != NULL)
+    shared_data->pid = pid;
+}
+
+/* Maps the shared data page read-only into page directory PD.
+   Returns true if successful, false on memory allocation
+   failure. */
+bool
+shared_data_map (uint32_t *pd) 
+{
+  return pagedir_set_page (pd, SHARED_DATA_ADDR, shared_data, false);
+}
+
+/* Removes the shared data page from PD, which must be done
+   before PD is destroyed so that the page is not freed along
+   with the process's own pages. */
+void
+shared_data_unmap (uint32_t *pd) 
+{
+  pagedir_clear_page (pd, SHARED_DATA_ADDR);
+}
@@ -0,0 +1,14 @@
+#ifndef USERPROG_SHARED_DATA_H
+#define USERPROG_SHARED_DATA_H
+
+#include <shared-data.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+void shared_data_init (void);
+void shared_data_tick (int64_t ticks);
+void shared_data_activate (int pid);
+bool shared_data_map (uint32_t *pd);
+void shared_data_unmap (uint32_t *pd);
+
+#endif /* userprog/shared-data.h */
@@ -1,12 +1,22 @@
 #include "userprog/syscall.h"
 #include <stdio.h>
+#include <string.h>
 #include <syscall-nr.h>
+#include <syscall-ring.h>
 #include "threads/interrupt.h"
 #include "threads/thread.h"
 #include "threads/vaddr.h"
+#include "devices/input.h"
 #include "devices/shutdown.h"
 #include "process.h"
+#include "filesys/directory.h"
 #include "filesys/file.h"
+#include "userprog/aio.h"
+#include "userprog/pipe.h"
+#ifdef VM
+#include "vm/mmap.h"
+#include "vm/page.h"
+#endif
 
 static void syscall_handler (struct intr_frame *);
 
@@ -23,6 +33,25 @@ int write (int fd , const void * buffer , unsigned size );
 void seek (int fd , unsigned position );
 unsigned tell (int fd );
 void close (int fd );
+bool ring_setup (struct syscall_ring *ring);
+int ring_enter (unsigned to_submit);
+int aio_read (int fd, void *buffer, unsigned size, unsigned offset);
+int aio_write (int fd, const void *buffer, unsigned size, unsigned offset);
+int aio_wait (struct aio_event *events, unsigned max);
+bool pipe (int *fds);
+int dup2 (int old_fd, int new_fd);
+int wait_any (int *status);
+#ifdef VM
+mapid_t mmap (int fd, void *addr);
+void munmap (mapid_t mapid);
+int exec_rss (const char *cmd_line, unsigned max_pages);
+int madvise (void *addr, unsigned length, int advice);
+#endif
+
+static int pread (int fd, void *buffer, unsigned size, unsigned offset);
+static int pwrite (int fd, const void *buffer, unsigned size,
+                   unsigned offset);
+static int ring_dispatch (const struct ring_sqe *sqe);
 
 struct lock filesys_lock;
 
@@ -33,25 +62,86 @@ syscall_init (void)
   intr_register_int (0x30, 3, INTR_ON, syscall_handler, "syscall");
 }
 
-void check_valid(void *ptr)
+// Returns whether PTR is a mapped user address.
+static bool valid_ptr(void *ptr)
 {
   void *usr_min_addr = 0x08048000;
-  if(!is_user_vaddr(ptr) || ptr < usr_min_addr) exit(-1);
+  if(!is_user_vaddr(ptr) || ptr < usr_min_addr) return false;
   int *cur_pd = thread_current()->pagedir;
-  if(!pagedir_get_page(cur_pd, ptr)) exit(-1);
-  return 0;
+#ifdef VM
+  // Fault the page in now, before any lock is taken.
+  return pagedir_get_page(cur_pd, ptr) || page_load(pg_round_down(ptr), false)
+         || page_grow_stack(ptr, thread_current()->user_esp);
+#else
+  return pagedir_get_page(cur_pd, ptr) != NULL;
+#endif
 }
 
-void check_valid_str(char *ptr)
+static bool valid_str(char *ptr)
 {
-  check_valid(ptr);
+  if(!valid_ptr(ptr)) return false;
   while(*ptr != '\0')
-    check_valid(++ptr);
+    if(!valid_ptr(++ptr)) return false;
+  return true;
+}
+
+static bool valid_buffer(char *ptr, unsigned size)
+{
+  if(size == 0) return true;
+  if(ptr + size < ptr) return false;
+  // One byte per page is enough.
+  if(!valid_ptr(ptr)) return false;
+  char *page;
+  for(page = pg_round_down(ptr) + PGSIZE; page < ptr + size; page += PGSIZE)
+    if(!valid_ptr(page)) return false;
+  return true;
+}
+
+// Copies the user string USTR into KSTR, a SIZE-byte kernel
+// buffer, so that the file system never reads user memory, which
+// could be paged out, while holding its lock.  A string too long
+// for KSTR is cut short.  Returns false if USTR is bad.
+static bool copy_in_str(char *kstr, const char *ustr, size_t size)
+{
+  if(!valid_str((char *) ustr)) return false;
+  strlcpy(kstr, ustr, size);
+  return true;
+}
+
+void check_valid(void *ptr)
+{
+  if(!valid_ptr(ptr)) exit(-1);
+}
+
+void check_valid_str(char *ptr)
+{
+  if(!valid_str(ptr)) exit(-1);
 }
 
-void check_valid_buffer(char *ptr, int size)
+void check_valid_buffer(char *ptr, unsigned size)
 {
-  while(size--) check_valid(ptr++);
+  if(!valid_buffer(ptr, size)) exit(-1);
+}
+
+// Validates a buffer the kernel will write to if WRITE, else
+// read from, and keeps its pages in memory until unpin_buffer()
+// so that nothing faults while the file system lock is held.
+// Returns false, with nothing pinned, if the buffer is bad.
+static bool pin_buffer(char *ptr, unsigned size, bool write UNUSED)
+{
+  if(!valid_buffer(ptr, size)) return false;
+#ifdef VM
+  return page_pin_buffer(ptr, size, write);
+#else
+  return true;
+#endif
+}
+
+static void unpin_buffer(char *ptr UNUSED, unsigned size UNUSED)
+{
+#ifdef VM
+  page_unpin_buffer(thread_current()->pagedir, ptr, size);
+#endif
 }
 
 int get_arg(void *esp)
@@ -76,6 +166,10 @@ syscall_handler (struct intr_frame *f)
 {
   int args[4];
   void *esp = f->esp;
+#ifdef VM
+  // Page faults taken on behalf of the process need its esp.
+  thread_current()->user_esp = esp;
+#endif
   int call_num = get_arg(esp);
   esp += 4;
   if(call_num == SYS_HALT)
@@ -100,21 +194,24 @@ syscall_handler (struct intr_frame *f)
   }
   else if(call_num == SYS_CREATE)
   {
+    char name[NAME_MAX + 2];
     get_args(esp, args, 2);
-    check_valid_str(args[0]);
-    f->eax = create(args[0], args[1]);
+    if(!copy_in_str(name, args[0], sizeof name)) exit(-1);
+    f->eax = create(name, args[1]);
   }
   else if(call_num == SYS_REMOVE)
   {
+    char name[NAME_MAX + 2];
     get_args(esp, args, 1);
-    check_valid_str(args[0]);
-    f->eax = remove(args[0]);
+    if(!copy_in_str(name, args[0], sizeof name)) exit(-1);
+    f->eax = remove(name);
   }
   else if(call_num == SYS_OPEN)
   {
+    char name[NAME_MAX + 2];
     get_args(esp, args, 1);
-    check_valid_str(args[0]);
-    f->eax = open(args[0]);
+    if(!copy_in_str(name, args[0], sizeof name)) exit(-1);
+    f->eax = open(name);
   }
   else if(call_num == SYS_FILESIZE)
   {
@@ -124,14 +221,16 @@ syscall_handler (struct intr_frame *f)
   else if(call_num == SYS_READ)
   {
     get_args(esp, args, 3);
-    check_valid_buffer(args[1], args[2]);
+    if(!pin_buffer(args[1], args[2], true)) exit(-1);
     f->eax = read(args[0], args[1], args[2]);
+    unpin_buffer(args[1], args[2]);
   }
   else if(call_num == SYS_WRITE)
   {
     get_args(esp, args, 3);
-    check_valid_buffer(args[1], args[2]);
+    if(!pin_buffer(args[1], args[2], false)) exit(-1);
     f->eax = write(args[0], args[1], args[2]);
+    unpin_buffer(args[1], args[2]);
   }
   else if(call_num == SYS_SEEK)
   {
@@ -148,6 +247,72 @@ syscall_handler (struct intr_frame *f)
     get_args(esp, args, 1);
     close(args[0]);
   }
+  else if(call_num == SYS_RING_SETUP)
+  {
+    get_args(esp, args, 1);
+    f->eax = ring_setup(args[0]);
+  }
+  else if(call_num == SYS_RING_ENTER)
+  {
+    get_args(esp, args, 1);
+    f->eax = ring_enter(args[0]);
+  }
+  else if(call_num == SYS_AIO_READ)
+  {
+    get_args(esp, args, 4);
+    f->eax = aio_read(args[0], args[1], args[2], args[3]);
+  }
+  else if(call_num == SYS_AIO_WRITE)
+  {
+    get_args(esp, args, 4);
+    f->eax = aio_write(args[0], args[1], args[2], args[3]);
+  }
+  else if(call_num == SYS_AIO_WAIT)
+  {
+    get_args(esp, args, 2);
+    check_valid_buffer(args[0], args[1] * sizeof (struct aio_event));
+    f->eax = aio_wait(args[0], args[1]);
+  }
+  else if(call_num == SYS_PIPE)
+  {
+    get_args(esp, args, 1);
+    check_valid_buffer(args[0], 2 * sizeof (int));
+    f->eax = pipe(args[0]);
+  }
+  else if(call_num == SYS_DUP2)
+  {
+    get_args(esp, args, 2);
+    f->eax = dup2(args[0], args[1]);
+  }
+  else if(call_num == SYS_WAIT_ANY)
+  {
+    get_args(esp, args, 1);
+    // A bad STATUS fails the call rather than killing the caller.
+    f->eax = valid_buffer(args[0], sizeof (int)) ? wait_any(args[0]) : -1;
+  }
+#ifdef VM
+  else if(call_num == SYS_MMAP)
+  {
+    get_args(esp, args, 2);
+    f->eax = mmap(args[0], args[1]);
+  }
+  else if(call_num == SYS_MUNMAP)
+  {
+    get_args(esp, args, 1);
+    munmap(args[0]);
+  }
+  else if(call_num == SYS_EXEC_RSS)
+  {
+    get_args(esp, args, 2);
+    check_valid_str(args[0]);
+    f->eax = exec_rss(args[0], args[1]);
+  }
+  else if(call_num == SYS_MADVISE)
+  {
+    get_args(esp, args, 3);
+    f->eax = madvise(args[0], args[1], args[2]);
+  }
+#endif
   else
   {
   	printf("Not known (yet) syscall.\n");
@@ -163,9 +328,8 @@ void exit(int status)
 {
   struct thread *cur = thread_current();
   printf("%s: exit(%d)\n", cur->name, status);
-  struct child_process *child = cur->child;
-  child->exit_retval = status;
-  child->exit_status = 1;
+  // process_exit() publishes this to the parent.
+  if(cur->child) cur->child->exit_retval = status;
   thread_exit();
 }
 int exec(const char *cmd_line)
@@ -188,6 +352,13 @@ int wait (int pid)
 {
   return process_wait(pid);
 }
+/* Waits for whichever child exits first, stores its exit status
+   into *STATUS and returns its pid, or returns -1 if there are
+   no children left to wait for. */
+int wait_any (int *status)
+{
+  return process_wait_any(status);
+}
 bool create (const char * file , unsigned initial_size )
 {
   lock_acquire(&filesys_lock);
@@ -218,7 +389,7 @@ int open (const char * file )
 int filesize (int fd )
 {
   struct file_descriptor *file_desc = process_get_fd(fd);
-  if(!file_desc) return -1;
+  if(!file_desc || !file_desc->file) return -1;
   lock_acquire(&filesys_lock);
   int res = file_length(file_desc->file);
   lock_release(&filesys_lock);
@@ -226,18 +397,13 @@ int filesize (int fd )
 }
 int read (int fd , void * buffer , unsigned size )
 {
-  if(fd == STDOUT_FILENO) return 0;
-  if(fd == STDIN_FILENO)
-  {
-    char *buff = (char *) buffer;
-    int i;
-    for(i=0; i<size; i++)
-      buff[i] = input_getc();
-    return size;
-  }
-
+  // stdin and stdout are the console unless redirected.
   struct file_descriptor *file_desc = process_get_fd(fd);
+  if(!file_desc && fd == STDIN_FILENO)
+    return input_getbuf(buffer, size);
   if(!file_desc) return 0;
+  if(file_desc->pipe)
+    return file_desc->write_end ? -1 : pipe_read(file_desc->pipe, buffer, size);
   lock_acquire(&filesys_lock);
   int bytes_read = file_read(file_desc->file, buffer, size);
   lock_release(&filesys_lock);
@@ -245,13 +411,15 @@ int read (int fd , void * buffer , unsigned size )
 }
 int write (int fd , const void * buffer , unsigned size )
 {
-  if (fd == STDOUT_FILENO)
+  struct file_descriptor *file_desc = process_get_fd(fd);
+  if (!file_desc && fd == STDOUT_FILENO)
   {
     putbuf(buffer, size);
     return size;
   }
-  struct file_descriptor *file_desc = process_get_fd(fd);
   if(!file_desc) return -1;
+  if(file_desc->pipe)
+    return file_desc->write_end ? pipe_write(file_desc->pipe, buffer, size) : -1;
   lock_acquire(&filesys_lock);
   int bytes_written = file_write(file_desc->file, buffer, size);
   lock_release(&filesys_lock);
@@ -260,7 +428,7 @@ int write (int fd , const void * buffer , unsigned size )
 void seek (int fd , unsigned position )
 {
   struct file_descriptor *file_desc = process_get_fd(fd);
-  if(!file_desc) return -1;
+  if(!file_desc || !file_desc->file) return -1;
   lock_acquire(&filesys_lock);
   file_seek(file_desc->file, position);
   lock_release(&filesys_lock);
@@ -268,7 +436,7 @@ void seek (int fd , unsigned position )
 unsigned tell (int fd )
 {
   struct file_descriptor *file_desc = process_get_fd(fd);
-  if(!file_desc) return -1;
+  if(!file_desc || !file_desc->file) return -1;
   lock_acquire(&filesys_lock);
   int res = file_tell(file_desc->file);
   lock_release(&filesys_lock);
@@ -279,4 +447,222 @@ void close (int fd )
   struct file_descriptor *file_desc = process_get_fd(fd);
   if(!file_desc) return -1;
   process_remove_fd(fd);
-}
\ No newline at end of file
+}
+
+/* Creates a pipe and stores the fds of its read and write ends
+   into FDS[0] and FDS[1]. */
+bool pipe (int *fds)
+{
+  struct pipe *p = pipe_create();
+  if(!p) return false;
+  struct file_descriptor *read_end = process_add_pipe(p, false);
+  if(!read_end)
+  {
+    pipe_close(p, false);
+    pipe_close(p, true);
+    return false;
+  }
+  struct file_descriptor *write_end = process_add_pipe(p, true);
+  if(!write_end)
+  {
+    process_remove_fd(read_end->fd);
+    pipe_close(p, true);
+    return false;
+  }
+  fds[0] = read_end->fd;
+  fds[1] = write_end->fd;
+  return true;
+}
+
+/* Makes NEW_FD refer to what OLD_FD refers to, closing NEW_FD
+   first if it is open.  NEW_FD must be STDIN_FILENO,
+   STDOUT_FILENO or a number already handed out; redirecting
+   stdin or stdout this way also redirects them for processes
+   exec()'d afterward.  Returns NEW_FD, or -1 on failure. */
+int dup2 (int old_fd, int new_fd)
+{
+  struct file_descriptor *file_desc = process_get_fd(old_fd);
+  if(!file_desc || new_fd < 0 || new_fd >= thread_current()->fd_id)
+    return -1;
+  if(old_fd == new_fd) return new_fd;
+  process_remove_fd(new_fd);
+  if(!process_dup_fd(file_desc, new_fd)) return -1;
+  return new_fd;
+}
+
+/* Queues an asynchronous read of SIZE bytes at OFFSET in the
+   file open as FD into BUFFER.  Returns a request id for
+   aio_wait(), or -1 if FD or BUFFER is bad. */
+int aio_read (int fd, void *buffer, unsigned size, unsigned offset)
+{
+  struct file_descriptor *file_desc = process_get_fd(fd);
+  if(!file_desc || !file_desc->file) return -1;
+  if(!valid_buffer(buffer, size)) return -1;
+  return aio_submit(file_desc->file, buffer, size, offset, false);
+}
+
+/* Queues an asynchronous write of SIZE bytes from BUFFER at
+   OFFSET in the file open as FD.  Returns a request id for
+   aio_wait(), or -1 if FD or BUFFER is bad. */
+int aio_write (int fd, const void *buffer, unsigned size, unsigned offset)
+{
+  struct file_descriptor *file_desc = process_get_fd(fd);
+  if(!file_desc || !file_desc->file) return -1;
+  if(!valid_buffer((char *) buffer, size)) return -1;
+  return aio_submit(file_desc->file, (void *) buffer, size, offset, true);
+}
+
+/* Stores up to MAX completed asynchronous requests into EVENTS,
+   blocking until at least one completes if any are pending.
+   Returns the number stored. */
+int aio_wait (struct aio_event *events, unsigned max)
+{
+  return aio_collect(events, max);
+}
+
+#ifdef VM
+/* Maps the file open as FD into memory at ADDR.  Returns the
+   mapping's id, or -1. */
+mapid_t mmap (int fd, void *addr)
+{
+  struct file_descriptor *file_desc = process_get_fd(fd);
+  if(!file_desc || !file_desc->file) return MAP_FAILED;
+  return mmap_map(file_desc->file, addr);
+}
+
+/* Unmaps MAPID, writing back the pages that were modified. */
+void munmap (mapid_t mapid)
+{
+  mmap_unmap(mapid);
+}
+
+/* Like exec(), but limits the new process to MAX_PAGES resident
+   pages, or the kernel's default if MAX_PAGES is 0. */
+int exec_rss (const char *cmd_line, unsigned max_pages)
+{
+  struct thread *cur = thread_current();
+  // thread_create() hands the limit to the new thread.
+  cur->child_rss_limit = max_pages;
+  int pid = exec(cmd_line);
+  cur->child_rss_limit = 0;
+  return pid;
+}
+
+/* Applies ADVICE, one of the MADV_* values, to the pages spanning
+   the LENGTH bytes at ADDR, which must be page-aligned.  Returns
+   0, or -1 if ADVICE is unknown or the range includes a page the
+   process doesn't have. */
+int madvise (void *addr, unsigned length, int advice)
+{
+  return page_advise(addr, length, advice) ? 0 : -1;
+}
+#endif
+
+/* Reads SIZE bytes at OFFSET in the file open as FD into BUFFER,
+   without moving the file position. */
+static int pread (int fd, void *buffer, unsigned size, unsigned offset)
+{
+  struct file_descriptor *file_desc = process_get_fd(fd);
+  if(!file_desc || !file_desc->file) return -1;
+  lock_acquire(&filesys_lock);
+  int bytes_read = file_read_at(file_desc->file, buffer, size, offset);
+  lock_release(&filesys_lock);
+  return bytes_read;
+}
+
+/* Writes SIZE bytes from BUFFER at OFFSET in the file open as FD,
+   without moving the file position. */
+static int pwrite (int fd, const void *buffer, unsigned size,
+                   unsigned offset)
+{
+  struct file_descriptor *file_desc = process_get_fd(fd);
+  if(!file_desc || !file_desc->file) return -1;
+  lock_acquire(&filesys_lock);
+  int bytes_written = file_write_at(file_desc->file, buffer, size, offset);
+  lock_release(&filesys_lock);
+  return bytes_written;
+}
+
+/* Registers RING as the current process's syscall ring, or
+   unregisters it if RING is null.  See lib/syscall-ring.h. */
+bool ring_setup (struct syscall_ring *ring)
+{
+  if(ring != NULL)
+    check_valid_buffer((char *) ring, sizeof *ring);
+  thread_current()->ring = ring;
+  return true;
+}
+
+/* Runs up to TO_SUBMIT queued requests from the current
+   process's ring, posting a completion for each, and returns
+   the number of requests consumed.  Stops early if the
+   submission queue runs dry or the completion queue fills up. */
+int ring_enter (unsigned to_submit)
+{
+  struct syscall_ring *ring = thread_current()->ring;
+  unsigned done = 0;
+  if(ring == NULL) return -1;
+  // Revalidate: the ring is ordinary user memory.
+  check_valid_buffer((char *) ring, sizeof *ring);
+  while(done < to_submit && ring->sq_head != ring->sq_tail
+        && ring->cq_tail - ring->cq_head < RING_ENTRIES)
+  {
+    // Copy the request so the process can't change it under us.
+    struct ring_sqe sqe = ring->sq[ring->sq_head % RING_ENTRIES];
+    ring->sq_head++;
+    int res = ring_dispatch(&sqe);
+    struct ring_cqe *cqe = &ring->cq[ring->cq_tail % RING_ENTRIES];
+    cqe->user_data = sqe.user_data;
+    cqe->res = res;
+    ring->cq_tail++;
+    done++;
+  }
+  return done;
+}
+
+/* Performs the request described by SQE and returns its result.
+   A bad user pointer fails only this request, with -1, instead of
+   killing the process as the equivalent syscall would. */
+static int ring_dispatch (const struct ring_sqe *sqe)
+{
+  char name[NAME_MAX + 2];
+  int res;
+  switch(sqe->op)
+  {
+    case RING_NOP:
+      return 0;
+    case RING_OPEN:
+      if(!copy_in_str(name, sqe->buf, sizeof name)) return -1;
+      return open(name);
+    case RING_CLOSE:
+      close(sqe->fd);
+      return 0;
+    case RING_READ:
+      if(!pin_buffer(sqe->buf, sqe->len, true)) return -1;
+      res = read(sqe->fd, sqe->buf, sqe->len);
+      unpin_buffer(sqe->buf, sqe->len);
+      return res;
+    case RING_WRITE:
+      if(!pin_buffer(sqe->buf, sqe->len, false)) return -1;
+      res = write(sqe->fd, sqe->buf, sqe->len);
+      unpin_buffer(sqe->buf, sqe->len);
+      return res;
+    case RING_PREAD:
+      if(!pin_buffer(sqe->buf, sqe->len, true)) return -1;
+      res = pread(sqe->fd, sqe->buf, sqe->len, sqe->ofs);
+      unpin_buffer(sqe->buf, sqe->len);
+      return res;
+    case RING_PWRITE:
+      if(!pin_buffer(sqe->buf, sqe->len, false)) return -1;
+      res = pwrite(sqe->fd, sqe->buf, sqe->len, sqe->ofs);
+      unpin_buffer(sqe->buf, sqe->len);
+      return res;
+    case RING_SEEK:
+      seek(sqe->fd, sqe->ofs);
+      return 0;
+    case RING_FILESIZE:
+      return filesize(sqe->fd);
+    default:
+      return -1;
+  }
+}
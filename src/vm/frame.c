@@ -1,34 +1,634 @@
 #include "vm/frame.h"
+#include <debug.h>
+#include <string.h>
+#include <stdio.h>
 #include "vm/page.h"
+#include "vm/policy.h"
+#include "vm/swap.h"
 #include "userprog/pagedir.h"
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
 #include "threads/palloc.h"
-#include "threads/pte.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
 
-void frame_init()
+/* Frame table.
+
+	 There is one entry for each page in the user pool, indexed by
+	 its page number relative to the start of the pool.  When the
+	 pool runs dry, frame_alloc() evicts a page, asking the page
+	 replacement policy in vm/policy.c which one.  The policy hears
+	 about every frame filled and vacated, and reads and clears the
+	 accessed bits through frame_referenced().
+
+	 A page-out thread keeps a few frames free so that faults
+	 rarely have to evict anything themselves: when an allocation
+	 leaves fewer than `free_low' frames free, it wakes up and
+	 reclaims frames the same way until `free_high' are free.
+
+	 frame_lock protects the table and the residency (`kpage') of
+	 every page in it.  Eviction writes pages bound for swap, and
+	 dirty pages of memory-mapped files, with the lock released, so
+	 that other threads can allocate free frames meanwhile; their
+	 frames are pinned and marked `evicting', and a thread that
+	 needs one of those pages back waits on `unpinned' until the
+	 write has finished.  The file system lock is never acquired
+	 with frame_lock held.
+
+	 A frame is also pinned while it is being loaded, and while a
+	 system call or asynchronous I/O request uses it as a buffer,
+	 so that the kernel never faults on a buffer with a lock held.
+	 Pins nest: the frame can be evicted again once every pin has
+	 been dropped.
+
+	 Each process's resident set size, the number of frames holding
+	 its pages, is counted in its `rss'.  A process that has reached
+	 its limit, set when it was started or with the -rss option,
+	 replaces its own pages rather than take free frames.
+
+	 Only pages that can't need swap are evicted while swap is
+	 full.  If there are none, the out-of-memory killer marks the
+	 process using the most frames and swap slots for death, and
+	 the allocation waits on `reclaimed' for it to exit.  The
+	 victim exits on its next return to user mode; only if it is
+	 the allocating process itself does the allocation fail. */
+
+/* A frame in the user pool. */
+struct frame
+{
+	struct sup_page_table_entry *spte;		/* Page held, or NULL if free. */
+	uint32_t *pagedir;										/* Page directory mapping SPTE. */
+	struct thread *owner;									/* Process owning SPTE. */
+	unsigned pin_cnt;											/* Never evict while nonzero. */
+	bool evicting;												/* Being written to swap. */
+};
+
+static struct frame *frames;		/* Frame table. */
+static size_t frame_cnt;				/* Number of entries in FRAMES. */
+static uint8_t *frame_base;			/* Kernel address of frames[0]. */
+static size_t evict_cnt;				/* Number of pages evicted. */
+static size_t oom_kill_cnt;			/* Number of processes killed. */
+
+/* Default resident set limit in frames, or 0 for none.  Set with
+	 the -rss kernel command line option. */
+size_t frame_rss_limit;
+
+/* What frame_evictable() accepts, for the eviction in progress:
+	 only frames mapped in `evict_pd', if it is nonnull, and only
+	 pages that can't need swap, if `evict_clean' is true. */
+static uint32_t *evict_pd;
+static bool evict_clean;
+
+static struct lock frame_lock;
+static struct condition unpinned;			/* A frame's last pin was dropped. */
+static struct condition pageout_wake;	/* Free frames are running low. */
+static struct condition reclaimed;		/* A process freed its memory. */
+
+/* Free frame watermarks for the page-out thread. */
+static size_t free_low, free_high;
+
+static void *frame_get(enum palloc_flags flags,
+											 struct sup_page_table_entry *spte, bool evict);
+static struct frame *frame_lookup(void *kpage);
+static void frame_vacate(struct frame *f);
+static void *frame_take(bool evict);
+static void *frame_evict(uint32_t *pd);
+static bool oom_kill(void);
+static thread_action_func oom_score;
+static thread_func pageout_daemon NO_RETURN;
+
+/* Initializes the frame table to cover the user pool. */
+void frame_init(void)
 {
-	list_init(&frame_table);
+	void *base;
+
+	palloc_user_pool(&base, &frame_cnt);
+	frame_base = base;
+	frames = calloc(frame_cnt, sizeof *frames);
+	if(frames == NULL && frame_cnt > 0)
+		PANIC("could not allocate frame table");
+	frame_policy->init(frame_cnt);
 	lock_init(&frame_lock);
+	cond_init(&unpinned);
+	cond_init(&pageout_wake);
+	cond_init(&reclaimed);
+
+	/* Start reclaiming with 1/32 of the pool free; stop at 1/16. */
+	free_low = frame_cnt / 32 > 2 ? frame_cnt / 32 : 2;
+	free_high = 2 * free_low;
+}
+
+/* Starts the page-out thread, unless there is no swap device for
+	 it to write to. */
+void frame_pageout_init(void)
+{
+	if(swap_available())
+		thread_create("pageout", PRI_DEFAULT, pageout_daemon, NULL);
+}
+
+/* Returns a frame to hold the page SPTE describes, a page of the
+	 current process, evicting some other page if the user pool is
+	 empty or the process is at its resident set limit.  Returns
+	 NULL if memory and swap are exhausted and the out-of-memory
+	 killer picks the current process.  FLAGS must include
+	 PAL_USER.  The frame is pinned until the caller, having filled
+	 and mapped it, calls frame_unpin().
+
+	 If SPTE's page turns out to be resident and mapped, because
+	 the page merging thread had only cleared its mapping for a
+	 moment, returns the page's own frame instead, also pinned,
+	 which the caller can tell by SPTE->kpage being equal to it. */
+void *frame_alloc(enum palloc_flags flags, struct sup_page_table_entry *spte)
+{
+	return frame_get(flags, spte, true);
+}
+
+/* Like frame_alloc(), but returns NULL instead of evicting a page
+	 if the user pool is empty or the process is at its limit. */
+void *frame_alloc_free(enum palloc_flags flags,
+											 struct sup_page_table_entry *spte)
+{
+	return frame_get(flags, spte, false);
 }
 
-void *frame_alloc(struct sup_page_table_entry *spte, enum palloc_flags flags)
+/* Implements frame_alloc() and, if EVICT is false,
+	 frame_alloc_free(). */
+static void *frame_get(enum palloc_flags flags,
+											 struct sup_page_table_entry *spte, bool evict)
 {
-	assert(flags & PAL_USER);
+	struct thread *cur = thread_current();
+	struct frame *f;
+	void *kpage;
 
-	void *addr = palloc_get_page(flags);
-	if(addr == NULL)
+	ASSERT(flags & PAL_USER);
+
+	lock_acquire(&frame_lock);
+
+	/* SPTE's page may still be on its way to swap.  If it is
+		 resident and not being evicted, it is mapped again. */
+	while(spte->kpage != NULL)
 	{
-		// try evict.
-		return NULL;
+		f = frame_lookup(spte->kpage);
+		if(!f->evicting)
+		{
+			f->pin_cnt++;
+			lock_release(&frame_lock);
+			return spte->kpage;
+		}
+		cond_wait(&unpinned, &frame_lock);
+	}
+
+	kpage = frame_take(evict);
+	while(kpage == NULL && evict && oom_kill())
+	{
+		cond_wait(&reclaimed, &frame_lock);
+		kpage = frame_take(evict);
+	}
+	if(kpage != NULL)
+	{
+		if(flags & PAL_ZERO)
+			memset(kpage, 0, PGSIZE);
+		f = frame_lookup(kpage);
+		f->spte = spte;
+		f->pagedir = cur->pagedir;
+		f->owner = cur;
+		f->pin_cnt = 1;
+		cur->rss++;
+		frame_policy->insert(f - frames, spte);
+	}
+	if(palloc_user_free_cnt() < free_low)
+		cond_signal(&pageout_wake, &frame_lock);
+	lock_release(&frame_lock);
+	return kpage;
+}
+
+/* Pins the frame holding SPTE, a page of the current process,
+	 and returns it, or returns NULL if the page is not resident or
+	 is being evicted. */
+void *frame_pin(struct sup_page_table_entry *spte)
+{
+	void *kpage;
+
+	lock_acquire(&frame_lock);
+	kpage = spte->kpage;
+	if(kpage != NULL && !frame_lookup(kpage)->evicting)
+		frame_lookup(kpage)->pin_cnt++;
+	else
+		kpage = NULL;
+	lock_release(&frame_lock);
+	return kpage;
+}
+
+/* Drops a pin on FRAME, which becomes a candidate for eviction
+	 again once it has no pins left.  FRAME may also be a shared
+	 frame outside the table, which is never pinned; then this
+	 does nothing. */
+void frame_unpin(void *frame)
+{
+	struct frame *f;
+
+	lock_acquire(&frame_lock);
+	f = frame_lookup(frame);
+	if(f->spte != NULL)
+	{
+		ASSERT(f->pin_cnt > 0);
+		if(--f->pin_cnt == 0)
+			cond_broadcast(&unpinned, &frame_lock);
 	}
-	return addr;
+	lock_release(&frame_lock);
 }
 
-void *frame_evict()
+/* Tells the replacement policy that SPTE's page, a page of the
+	 current process, won't be needed again soon, if it is resident
+	 and not pinned. */
+void frame_demote(struct sup_page_table_entry *spte)
 {
-	return NULL;
+	struct frame *f;
+
+	lock_acquire(&frame_lock);
+	if(spte->kpage != NULL)
+	{
+		f = frame_lookup(spte->kpage);
+		if(f->pin_cnt == 0)
+		{
+			pagedir_set_accessed(f->pagedir, spte->upage, false);
+			frame_policy->demote(f - frames);
+		}
+	}
+	lock_release(&frame_lock);
 }
 
+/* Frees FRAME, which frame_alloc() returned and which is still
+	 pinned. */
 void frame_free(void *frame)
 {
+	struct frame *f;
+
+	lock_acquire(&frame_lock);
+	f = frame_lookup(frame);
+	ASSERT(f->pin_cnt == 1);
+	frame_vacate(f);
+	palloc_free_page(frame);
+	lock_release(&frame_lock);
+}
+
+/* If SPTE's page is in a frame, removes its mapping from PD,
+	 frees the frame, and returns true.  The page is not kept
+	 anywhere, except that a dirty mapped page is written back to
+	 its file.  Returns false if the page is not resident.  Waits
+	 first for any I/O using the frame to finish. */
+bool frame_drop(struct sup_page_table_entry *spte, uint32_t *pd)
+{
+	void *kpage;
+	struct frame *f;
+	bool resident;
+
+	lock_acquire(&frame_lock);
+	while(spte->kpage != NULL && frame_lookup(spte->kpage)->pin_cnt > 0)
+		cond_wait(&unpinned, &frame_lock);
+	kpage = spte->kpage;
+	resident = kpage != NULL;
+	if(resident)
+	{
+		f = frame_lookup(kpage);
+		if(page_unmap(spte, pd) && spte->type == PAGE_MMAP)
+		{
+			/* Write back without the lock, keeping eviction away. */
+			f->pin_cnt = 1;
+			f->evicting = true;
+			lock_release(&frame_lock);
+			page_write_back(spte);
+			lock_acquire(&frame_lock);
+		}
+		spte->kpage = NULL;
+		frame_vacate(f);
+		palloc_free_page(kpage);
+	}
+	lock_release(&frame_lock);
+	return resident;
+}
+
+/* Returns the number of frames in the frame table. */
+size_t frame_count(void)
+{
+	return frame_cnt;
+}
+
+/* Acquires the frame table lock, which frame_owner(),
+	 frame_evictable(), frame_referenced(), frame_detach() and
+	 frame_release() require, and which keeps every page's
+	 residency from changing. */
+void frame_lock_acquire(void)
+{
+	lock_acquire(&frame_lock);
+}
+
+/* Wakes up allocations waiting for a process killed for lack of
+	 memory to free it.  Called when a process's pages have all
+	 been freed. */
+void frame_reclaimed(void)
+{
+	lock_acquire(&frame_lock);
+	cond_broadcast(&reclaimed, &frame_lock);
+	lock_release(&frame_lock);
+}
+
+/* Releases the frame table lock. */
+void frame_lock_release(void)
+{
+	lock_release(&frame_lock);
+}
+
+/* If frame IDX holds a page that may be evicted, stores the page
+	 and the page directory mapping it in *SPTE and *PD and returns
+	 the frame; otherwise returns NULL. */
+void *frame_owner(size_t idx, struct sup_page_table_entry **spte,
+									uint32_t **pd)
+{
+	struct frame *f = &frames[idx];
+
+	ASSERT(lock_held_by_current_thread(&frame_lock));
+	ASSERT(idx < frame_cnt);
+
+	if(f->spte == NULL || f->pin_cnt > 0)
+		return NULL;
+	*spte = f->spte;
+	*pd = f->pagedir;
+	return frame_base + idx * PGSIZE;
+}
+
+/* Returns true if frame IDX holds a page that the eviction in
+	 progress may take. */
+bool frame_evictable(size_t idx)
+{
+	struct frame *f = &frames[idx];
+
+	ASSERT(lock_held_by_current_thread(&frame_lock));
+	ASSERT(idx < frame_cnt);
+
+	return f->spte != NULL && f->pin_cnt == 0
+		&& (evict_pd == NULL || f->pagedir == evict_pd)
+		&& (!evict_clean || !page_may_swap(f->spte));
+}
+
+/* Returns true if the page in frame IDX has been accessed since
+	 the last call, clearing its accessed bit.  Returns false if
+	 the frame is free. */
+bool frame_referenced(size_t idx)
+{
+	struct frame *f = &frames[idx];
+
+	ASSERT(lock_held_by_current_thread(&frame_lock));
+	ASSERT(idx < frame_cnt);
+
+	if(f->spte == NULL || !pagedir_is_accessed(f->pagedir, f->spte->upage))
+		return false;
+	pagedir_set_accessed(f->pagedir, f->spte->upage, false);
+	return true;
+}
+
+/* Stops tracking FRAME, whose page no longer lives in it, without
+	 freeing it.  The caller becomes responsible for freeing it
+	 with palloc_free_page(). */
+void frame_detach(void *frame)
+{
+	ASSERT(lock_held_by_current_thread(&frame_lock));
+
+	frame_vacate(frame_lookup(frame));
+}
+
+/* Frees FRAME, whose page no longer lives in it. */
+void frame_release(void *frame)
+{
+	frame_detach(frame);
 	palloc_free_page(frame);
 }
+
+/* Returns the frame table entry for KPAGE. */
+static struct frame *frame_lookup(void *kpage)
+{
+	size_t idx = pg_no(kpage) - pg_no(frame_base);
+
+	ASSERT(pg_ofs(kpage) == 0);
+	ASSERT(idx < frame_cnt);
+	return &frames[idx];
+}
+
+/* Marks F free, telling the replacement policy. */
+static void frame_vacate(struct frame *f)
+{
+	frame_policy->remove(f - frames);
+	f->owner->rss--;
+	f->spte = NULL;
+	f->pagedir = NULL;
+	f->owner = NULL;
+	f->pin_cnt = 0;
+	f->evicting = false;
+}
+
+/* Takes a frame for the current process: one of its own pages'
+	 if it is at its resident set limit, or else a free frame, or
+	 else, if EVICT is true, any page's.  Returns NULL if there is
+	 none to take. */
+static void *frame_take(bool evict)
+{
+	struct thread *cur = thread_current();
+	size_t limit = cur->rss_limit != 0 ? cur->rss_limit : frame_rss_limit;
+	void *kpage = NULL;
+
+	if(limit != 0 && cur->rss >= limit)
+	{
+		if(!evict)
+			return NULL;
+		kpage = frame_evict(cur->pagedir);
+	}
+	if(kpage == NULL)
+		kpage = palloc_get_page(PAL_USER);
+	if(kpage == NULL && evict)
+		kpage = frame_evict(NULL);
+	return kpage;
+}
+
+/* Reclaims one or more frames chosen by the replacement policy
+	 and returns one of them, now unowned, freeing the rest.  Takes
+	 only frames mapped in PD, unless PD is null.  Returns NULL if
+	 the policy finds no frame it may take.  Called with frame_lock
+	 held, which it releases while writing pages out.
+
+	 If the first victim must be written out, up to SWAP_CLUSTER
+	 victims are taken, so that their pages bound for swap go in
+	 one transfer.  A slot is reserved for each victim that might
+	 need one; once none can be, only pages that can't are taken. */
+static void *frame_evict(uint32_t *pd)
+{
+	struct sup_page_table_entry *batch[SWAP_CLUSTER];
+	struct thread *batch_owner[SWAP_CLUSTER];
+	void *batch_kpage[SWAP_CLUSTER];
+	size_t batch_cnt = 0;
+	void *result = NULL;
+	size_t i;
+
+	for(i = 0; i < SWAP_CLUSTER; i++)
+	{
+		bool reserved = swap_reserve();
+		struct frame *f;
+		size_t idx;
+		void *kpage;
+
+		evict_pd = pd;
+		evict_clean = !reserved;
+		idx = frame_policy->victim();
+		evict_pd = NULL;
+		evict_clean = false;
+		if(idx == FRAME_NONE)
+		{
+			if(reserved)
+				swap_unreserve();
+			break;
+		}
+		f = &frames[idx];
+		kpage = frame_base + idx * PGSIZE;
+		evict_cnt++;
+
+		if(page_unmap(f->spte, f->pagedir))
+		{
+			/* A dirty mapped page goes back to its file instead. */
+			if(f->spte->type == PAGE_MMAP)
+			{
+				if(reserved)
+					swap_unreserve();
+			}
+			else
+				ASSERT(reserved);
+			f->pin_cnt = 1;
+			f->evicting = true;
+			batch[batch_cnt] = f->spte;
+			batch_owner[batch_cnt] = f->owner;
+			batch_kpage[batch_cnt++] = kpage;
+		}
+		else
+		{
+			if(reserved)
+				swap_unreserve();
+			frame_vacate(f);
+			if(result == NULL)
+				result = kpage;
+			else
+				palloc_free_page(kpage);
+			if(batch_cnt == 0)
+				break;
+		}
+	}
+
+	if(batch_cnt > 0)
+	{
+		lock_release(&frame_lock);
+		page_write_out(batch, batch_owner, batch_cnt);
+		lock_acquire(&frame_lock);
+
+		for(i = 0; i < batch_cnt; i++)
+		{
+			batch[i]->kpage = NULL;
+			frame_vacate(frame_lookup(batch_kpage[i]));
+			if(result == NULL)
+				result = batch_kpage[i];
+			else
+				palloc_free_page(batch_kpage[i]);
+		}
+		cond_broadcast(&unpinned, &frame_lock);
+	}
+	return result;
+}
+
+/* Best victim found so far by oom_score(). */
+struct oom_victim
+{
+	struct thread *thread;						/* Process to kill, or NULL. */
+	size_t score;											/* Its frames plus swap slots. */
+};
+
+/* Memory and swap are exhausted: picks the process using the
+	 most frames and swap slots, among those that are running,
+	 ready to run, or already dying, and marks it for death.
+	 Returns true if the caller should wait for it to exit, false
+	 if the caller should fail because it is the victim itself. */
+static bool oom_kill(void)
+{
+	struct thread *cur = thread_current();
+	struct oom_victim v = {NULL, 0};
+	char name[sizeof cur->name];
+	enum intr_level old_level;
+	bool killed = false;
+	size_t rss = 0, swap_cnt = 0;
+	tid_t tid = TID_ERROR;
+
+	if(cur->oom_killed)
+		return false;
+
+	old_level = intr_disable();
+	thread_foreach(oom_score, &v);
+	if(v.thread != NULL && v.thread != cur && !v.thread->oom_killed)
+	{
+		v.thread->oom_killed = true;
+		killed = true;
+		strlcpy(name, v.thread->name, sizeof name);
+		tid = v.thread->tid;
+		rss = v.thread->rss;
+		swap_cnt = v.thread->swap_cnt;
+	}
+	intr_set_level(old_level);
+
+	if(killed)
+	{
+		oom_kill_cnt++;
+		printf("Out of memory: killed process %d (%s), "
+					 "%zu frames, %zu swap slots\n", tid, name, rss, swap_cnt);
+
+		/* The victim may be waiting for memory itself. */
+		cond_broadcast(&reclaimed, &frame_lock);
+	}
+	return v.thread != NULL && v.thread != cur;
+}
+
+/* Offers T to the out-of-memory killer's search, whose best
+	 victim so far is in AUX, a struct oom_victim. */
+static void oom_score(struct thread *t, void *aux)
+{
+	struct oom_victim *v = aux;
+	size_t score = t->rss + t->swap_cnt;
+
+	if(t->pagedir == NULL
+		 || (t->status == THREAD_BLOCKED && !t->oom_killed))
+		return;
+	if(v->thread == NULL || score > v->score)
+	{
+		v->thread = t;
+		v->score = score;
+	}
+}
+
+/* Page-out thread: each time free frames run low, reclaims
+	 frames until `free_high' are free. */
+static void pageout_daemon(void *aux UNUSED)
+{
+	lock_acquire(&frame_lock);
+	for(;;)
+	{
+		cond_wait(&pageout_wake, &frame_lock);
+		while(palloc_user_free_cnt() < free_high)
+		{
+			void *kpage = frame_evict(NULL);
+			if(kpage == NULL)
+				break;
+			palloc_free_page(kpage);
+		}
+	}
+}
+
+/* Prints frame table statistics. */
+void frame_print_stats(void)
+{
+	printf("Frame: %s policy, %zu evictions, %zu processes killed\n",
+				 frame_policy->name, evict_cnt, oom_kill_cnt);
+}
@@ -1,30 +1,37 @@
 #ifndef VM_FRAME_H
 #define VM_FRAME_H
 
-#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include "threads/palloc.h"
-#include "threads/synch.h"
-#include "threads/vaddr.h"
 
-/*  */
+struct sup_page_table_entry;
 
-struct frame_table_entry
-{
-	void *frame;													/* Physical address of the frame. */
-	struct sup_page_table_entry *spte;		/* The corresponding sup page table entry. */
-	struct thread *thread;								/* The thread owning this frame. */
-	struct list_elem elem;								/* Element in the frame_table list. */
-};
-
-struct list frame_table;
-
-struct lock frame_lock;
+/* Default resident set limit in frames, or 0 for none. */
+extern size_t frame_rss_limit;
 
 void frame_init(void);
+void frame_pageout_init(void);
 void *frame_alloc(enum palloc_flags flags, struct sup_page_table_entry *spte);
-void frame_evict();
+void *frame_alloc_free(enum palloc_flags flags,
+											 struct sup_page_table_entry *spte);
+void *frame_pin(struct sup_page_table_entry *spte);
+void frame_unpin(void *frame);
+void frame_demote(struct sup_page_table_entry *spte);
 void frame_free(void *frame);
-
-
-
-#endif /* vm/frame.h */
\ No newline at end of file
+bool frame_drop(struct sup_page_table_entry *spte, uint32_t *pd);
+void frame_reclaimed(void);
+
+size_t frame_count(void);
+void frame_lock_acquire(void);
+void frame_lock_release(void);
+void *frame_owner(size_t idx, struct sup_page_table_entry **spte,
+									uint32_t **pd);
+bool frame_evictable(size_t idx);
+bool frame_referenced(size_t idx);
+void frame_detach(void *frame);
+void frame_release(void *frame);
+
+void frame_print_stats(void);
+
+#endif /* vm/frame.h */
@@ -0,0 +1,313 @@
+#include "vm/ksm.h"
+#include <debug.h>
+#include <hash.h>
+#include <stdio.h>
+#include <string.h>
+#include "vm/frame.h"
+#include "vm/page.h"
+#include "devices/timer.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/pagedir.h"
+
+/* Kernel same-page merging.
+
+	 A background thread walks the frame table a few pages at a
+	 time, hashing the contents of each page with hash_bytes().  A
+	 page whose hash has not changed since the previous visit is
+	 looked up first among the shared frames, the "stable" pages,
+	 and then among the other pages seen on this pass of the table,
+	 the "unstable" candidates.  When another page with the same
+	 contents turns up, both are mapped read-only to one frame and
+	 the other frame is freed.  Writing to a merged page faults,
+	 and page_load() gives the page a private copy again.
+
+	 Pages are compared byte for byte, with their mappings cleared
+	 so that their owners can't change them meanwhile, before they
+	 are merged: equal hashes only make a match likely.  All of
+	 this happens under the frame table lock, so an owner that
+	 faults on its page meanwhile finds it either merged or mapped
+	 again once frame_alloc() gets the lock.  Shared
+	 frames are not in the frame table and are never evicted.
+	 Pages of memory-mapped files are not merged, since they must
+	 be written back to their own files.
+
+	 ksm_lock protects the stable pages and the counts.  The
+	 scanner takes it while holding the frame table lock. */
+
+/* Pages examined per batch, and ticks to sleep between batches. */
+#define KSM_SCAN_PAGES 64
+#define KSM_SLEEP (TIMER_FREQ / 10)
+
+/* Number of buckets of stable pages. */
+#define KSM_BUCKETS 64
+
+/* A page seen on the current pass of the frame table. */
+struct candidate
+{
+	void *kpage;											/* Frame holding it, or NULL. */
+	size_t idx;												/* Index of KPAGE in the frame table. */
+	unsigned checksum;								/* hash_bytes() of its contents. */
+};
+
+static struct list stable[KSM_BUCKETS];	/* Shared frames by checksum. */
+static struct candidate *unstable;			/* Candidates by checksum. */
+static unsigned *checksums;							/* Last checksum of each frame. */
+static size_t scan_cnt;									/* Size of both arrays. */
+static size_t scan_hand;								/* Next frame to examine. */
+
+static size_t shared_cnt;		/* Shared frames. */
+static size_t sharing_cnt;	/* Pages mapping shared frames. */
+
+static struct lock ksm_lock;
+
+static thread_func ksm_daemon NO_RETURN;
+static void scan(size_t idx);
+static struct ksm_page *stable_find(const void *kpage, unsigned checksum);
+static bool merge_candidate(void *kpage, struct sup_page_table_entry *spte,
+														uint32_t *pd, struct candidate *c);
+static bool merge_stable(void *kpage, struct sup_page_table_entry *spte,
+												 uint32_t *pd, struct ksm_page *k);
+static bool unmap(struct sup_page_table_entry *spte, uint32_t *pd);
+static void remap(struct sup_page_table_entry *spte, uint32_t *pd,
+									void *kpage, bool dirty);
+static void share(struct sup_page_table_entry *spte, uint32_t *pd,
+									struct ksm_page *k);
+
+/* Starts the page merging thread. */
+void ksm_init(void)
+{
+	size_t i;
+
+	for(i = 0; i < KSM_BUCKETS; i++)
+		list_init(&stable[i]);
+	lock_init(&ksm_lock);
+
+	scan_cnt = frame_count();
+	if(scan_cnt == 0)
+		return;
+	unstable = calloc(scan_cnt, sizeof *unstable);
+	checksums = calloc(scan_cnt, sizeof *checksums);
+	if(unstable == NULL || checksums == NULL)
+		PANIC("could not allocate page merging tables");
+	thread_create("ksmd", PRI_MIN, ksm_daemon, NULL);
+}
+
+/* Drops a reference to K, freeing its frame when no page maps it
+	 any longer. */
+void ksm_put(struct ksm_page *k)
+{
+	lock_acquire(&ksm_lock);
+	ASSERT(k->ref > 0);
+	sharing_cnt--;
+	if(--k->ref == 0)
+	{
+		list_remove(&k->elem);
+		shared_cnt--;
+		palloc_free_page(k->kpage);
+		free(k);
+	}
+	lock_release(&ksm_lock);
+}
+
+/* If SPTE, which is not in a frame of its own, is mapped to a
+	 shared frame, removes its mapping from PD, drops its reference
+	 to the frame, and returns true.  Otherwise returns false. */
+bool ksm_drop(struct sup_page_table_entry *spte, uint32_t *pd)
+{
+	struct ksm_page *k = spte->ksm;
+
+	if(k == NULL)
+		return false;
+	pagedir_clear_page(pd, spte->upage);
+	spte->ksm = NULL;
+	ksm_put(k);
+	return true;
+}
+
+/* Returns the number of frames that merging has saved. */
+size_t ksm_merged_pages(void)
+{
+	size_t merged;
+
+	lock_acquire(&ksm_lock);
+	merged = sharing_cnt - shared_cnt;
+	lock_release(&ksm_lock);
+	return merged;
+}
+
+/* Prints page merging statistics. */
+void ksm_print_stats(void)
+{
+	printf("KSM: %zu pages merged into %zu frames\n", sharing_cnt, shared_cnt);
+}
+
+/* Page merging thread: scans KSM_SCAN_PAGES frames, then sleeps,
+	 forever. */
+static void ksm_daemon(void *aux UNUSED)
+{
+	for(;;)
+	{
+		size_t i;
+
+		for(i = 0; i < KSM_SCAN_PAGES; i++)
+		{
+			/* Candidates from the previous pass may have changed. */
+			if(scan_hand == 0)
+				memset(unstable, 0, scan_cnt * sizeof *unstable);
+			frame_lock_acquire();
+			scan(scan_hand);
+			frame_lock_release();
+			scan_hand = (scan_hand + 1) % scan_cnt;
+		}
+		timer_sleep(KSM_SLEEP);
+	}
+}
+
+/* Tries to merge the page in frame IDX with another page that
+	 has the same contents.  Called with the frame table lock
+	 held. */
+static void scan(size_t idx)
+{
+	struct sup_page_table_entry *spte;
+	struct ksm_page *k;
+	struct candidate *c;
+	uint32_t *pd;
+	unsigned checksum;
+	void *kpage;
+
+	kpage = frame_owner(idx, &spte, &pd);
+	if(kpage == NULL || spte->type == PAGE_MMAP)
+	{
+		checksums[idx] = 0;
+		return;
+	}
+
+	/* Don't bother with a page that is still changing. */
+	checksum = hash_bytes(kpage, PGSIZE);
+	if(checksum != checksums[idx])
+	{
+		checksums[idx] = checksum;
+		return;
+	}
+
+	lock_acquire(&ksm_lock);
+	k = stable_find(kpage, checksum);
+	if(k == NULL || !merge_stable(kpage, spte, pd, k))
+	{
+		c = &unstable[checksum % scan_cnt];
+		if(c->kpage != NULL && c->idx != idx && c->checksum == checksum
+			 && merge_candidate(kpage, spte, pd, c))
+			c->kpage = NULL;
+		else
+		{
+			c->kpage = kpage;
+			c->idx = idx;
+			c->checksum = checksum;
+		}
+	}
+	lock_release(&ksm_lock);
+}
+
+/* Returns a shared frame whose contents match KPAGE, which has
+	 the given CHECKSUM, or NULL if there is none. */
+static struct ksm_page *stable_find(const void *kpage, unsigned checksum)
+{
+	struct list *bucket = &stable[checksum % KSM_BUCKETS];
+	struct list_elem *e;
+
+	for(e = list_begin(bucket); e != list_end(bucket); e = list_next(e))
+	{
+		struct ksm_page *k = list_entry(e, struct ksm_page, elem);
+		if(k->checksum == checksum && !memcmp(k->kpage, kpage, PGSIZE))
+			return k;
+	}
+	return NULL;
+}
+
+/* Maps SPTE, in frame KPAGE and mapped in PD, to shared frame K
+	 and frees KPAGE, if its contents still match K's.  Returns
+	 true if successful. */
+static bool merge_stable(void *kpage, struct sup_page_table_entry *spte,
+												 uint32_t *pd, struct ksm_page *k)
+{
+	bool dirty = unmap(spte, pd);
+
+	if(memcmp(kpage, k->kpage, PGSIZE))
+	{
+		remap(spte, pd, kpage, dirty);
+		return false;
+	}
+	share(spte, pd, k);
+	frame_release(kpage);
+	return true;
+}
+
+/* Turns the frame of candidate C into a shared frame and maps
+	 both it and SPTE, in frame KPAGE and mapped in PD, to it, if
+	 C still holds a page whose contents match KPAGE's.  Returns
+	 true if successful. */
+static bool merge_candidate(void *kpage, struct sup_page_table_entry *spte,
+														uint32_t *pd, struct candidate *c)
+{
+	struct sup_page_table_entry *c_spte;
+	uint32_t *c_pd;
+	struct ksm_page *k;
+	bool dirty, c_dirty;
+
+	if(frame_owner(c->idx, &c_spte, &c_pd) != c->kpage
+		 || c_spte->type == PAGE_MMAP)
+		return false;
+
+	c_dirty = unmap(c_spte, c_pd);
+	dirty = unmap(spte, pd);
+	if(memcmp(kpage, c->kpage, PGSIZE) || (k = malloc(sizeof *k)) == NULL)
+	{
+		remap(c_spte, c_pd, c->kpage, c_dirty);
+		remap(spte, pd, kpage, dirty);
+		return false;
+	}
+
+	/* Either page may have changed since it was hashed. */
+	k->kpage = c->kpage;
+	k->checksum = hash_bytes(k->kpage, PGSIZE);
+	k->ref = 0;
+	list_push_back(&stable[k->checksum % KSM_BUCKETS], &k->elem);
+	shared_cnt++;
+	share(c_spte, c_pd, k);
+	share(spte, pd, k);
+	frame_detach(k->kpage);
+	frame_release(kpage);
+	return true;
+}
+
+/* Clears SPTE's mapping in PD, so that its owner can't modify the
+	 page, and returns whether the page was dirty. */
+static bool unmap(struct sup_page_table_entry *spte, uint32_t *pd)
+{
+	pagedir_clear_page(pd, spte->upage);
+	return pagedir_is_dirty(pd, spte->upage);
+}
+
+/* Maps SPTE back to KPAGE in PD after unmap(), dirty if DIRTY. */
+static void remap(struct sup_page_table_entry *spte, uint32_t *pd,
+									void *kpage, bool dirty)
+{
+	pagedir_set_page(pd, spte->upage, kpage, spte->writable);
+	if(dirty)
+		pagedir_set_dirty(pd, spte->upage, true);
+}
+
+/* Maps SPTE read-only to shared frame K in PD after unmap(). */
+static void share(struct sup_page_table_entry *spte, uint32_t *pd,
+									struct ksm_page *k)
+{
+	pagedir_set_page(pd, spte->upage, k->kpage, false);
+	spte->ksm = k;
+	spte->kpage = NULL;
+	k->ref++;
+	sharing_cnt++;
+}
@@ -0,0 +1,26 @@
+#ifndef VM_KSM_H
+#define VM_KSM_H
+
+#include <list.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct sup_page_table_entry;
+
+/* A frame shared read-only by pages with identical contents. */
+struct ksm_page
+{
+	void *kpage;											/* Shared frame. */
+	unsigned checksum;								/* hash_bytes() of its contents. */
+	size_t ref;												/* Pages mapping it. */
+	struct list_elem elem;						/* Element in a stable bucket. */
+};
+
+void ksm_init(void);
+void ksm_put(struct ksm_page *k);
+bool ksm_drop(struct sup_page_table_entry *spte, uint32_t *pd);
+size_t ksm_merged_pages(void);
+void ksm_print_stats(void);
+
+#endif /* vm/ksm.h */
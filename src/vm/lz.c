@@ -0,0 +1,193 @@
+#include "vm/lz.h"
+#include <debug.h>
+#include <stdint.h>
+#include <string.h>
+
+/* LZ77 compression in the style of LZ4, fast enough to run on
+	 every page written to swap.
+
+	 The compressed form is a series of sequences, each a token
+	 byte followed by a run of literal bytes and then a match: a
+	 copy of earlier output, given as a 2-byte little-endian
+	 distance back.  The token's high nibble is the number of
+	 literals and its low nibble the match length minus
+	 LZ_MIN_MATCH; a nibble of 15 is followed by more length
+	 bytes, each added in, until one is less than 255.  The last
+	 sequence has literals only and ends the input.
+
+	 Matches are found through a table indexed by a hash of the
+	 next LZ_MIN_MATCH bytes, remembering the last position that
+	 had each hash.  The table is static, so calls must not
+	 overlap. */
+
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_DISTANCE 65535
+#define LZ_HASH_BITS 10
+
+/* Last position + 1 with each hash, or 0. */
+static uint16_t lz_table[1 << LZ_HASH_BITS];
+
+static unsigned hash4(const uint8_t *p);
+static bool put_len(uint8_t **op, const uint8_t *oend, size_t len);
+static bool get_len(const uint8_t **ip, const uint8_t *iend, size_t *len);
+
+/* Compresses the SIZE bytes at SRC into DST, which holds MAX
+	 bytes.  Returns the compressed size, or 0 if it would exceed
+	 MAX.  SIZE must be at most 65535. */
+size_t lz_compress(const void *src_, size_t size, void *dst_, size_t max)
+{
+	const uint8_t *src = src_;
+	const uint8_t *ip = src, *anchor = src;
+	const uint8_t *end = src + size;
+	uint8_t *dst = dst_, *op = dst;
+	const uint8_t *oend = dst + max;
+	size_t lit;
+
+	ASSERT(size <= UINT16_MAX);
+
+	memset(lz_table, 0, sizeof lz_table);
+	while(end - ip >= LZ_MIN_MATCH)
+	{
+		unsigned h = hash4(ip);
+		const uint8_t *ref = src + lz_table[h] - 1;
+		bool found = lz_table[h] != 0 && ip - ref <= LZ_MAX_DISTANCE
+			&& !memcmp(ref, ip, LZ_MIN_MATCH);
+		size_t len, distance;
+
+		lz_table[h] = ip - src + 1;
+		if(!found)
+		{
+			ip++;
+			continue;
+		}
+
+		len = LZ_MIN_MATCH;
+		while(ip + len < end && ref[len] == ip[len])
+			len++;
+		lit = ip - anchor;
+		distance = ip - ref;
+
+		if(oend - op < 1)
+			return 0;
+		*op++ = (lit < 15 ? lit : 15) << 4
+			| (len - LZ_MIN_MATCH < 15 ? len - LZ_MIN_MATCH : 15);
+		if(lit >= 15 && !put_len(&op, oend, lit - 15))
+			return 0;
+		if((size_t) (oend - op) < lit + 2)
+			return 0;
+		memcpy(op, anchor, lit);
+		op += lit;
+		*op++ = distance & 0xff;
+		*op++ = distance >> 8;
+		if(len - LZ_MIN_MATCH >= 15
+			 && !put_len(&op, oend, len - LZ_MIN_MATCH - 15))
+			return 0;
+
+		ip += len;
+		anchor = ip;
+	}
+
+	/* Final literals. */
+	lit = end - anchor;
+	if(oend - op < 1)
+		return 0;
+	*op++ = (lit < 15 ? lit : 15) << 4;
+	if(lit >= 15 && !put_len(&op, oend, lit - 15))
+		return 0;
+	if((size_t) (oend - op) < lit)
+		return 0;
+	memcpy(op, anchor, lit);
+	op += lit;
+	return op - dst;
+}
+
+/* Decompresses the SIZE bytes at SRC, produced by lz_compress(),
+	 into DST.  Returns true if they decompress to exactly DST_SIZE
+	 bytes, false if they are malformed or decompress to some other
+	 size. */
+bool lz_decompress(const void *src, size_t size, void *dst_, size_t dst_size)
+{
+	const uint8_t *ip = src;
+	const uint8_t *iend = ip + size;
+	uint8_t *dst = dst_, *op = dst;
+	uint8_t *oend = dst + dst_size;
+
+	while(ip < iend)
+	{
+		unsigned token = *ip++;
+		size_t lit = token >> 4;
+		size_t len = token & 15;
+		size_t distance;
+
+		if(lit == 15 && !get_len(&ip, iend, &lit))
+			return false;
+		if((size_t) (iend - ip) < lit || (size_t) (oend - op) < lit)
+			return false;
+		memcpy(op, ip, lit);
+		op += lit;
+		ip += lit;
+		if(ip == iend)
+			break;
+
+		if(iend - ip < 2)
+			return false;
+		distance = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if(len == 15 && !get_len(&ip, iend, &len))
+			return false;
+		len += LZ_MIN_MATCH;
+		if(distance == 0 || distance > (size_t) (op - dst)
+			 || (size_t) (oend - op) < len)
+			return false;
+
+		/* The match may overlap its own output. */
+		while(len-- > 0)
+		{
+			*op = op[-distance];
+			op++;
+		}
+	}
+	return op == oend;
+}
+
+/* Returns the hash table index for the LZ_MIN_MATCH bytes at P. */
+static unsigned hash4(const uint8_t *p)
+{
+	uint32_t v = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+	return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+/* Appends LEN, the part of a length past a nibble of 15, at *OP,
+	 advancing *OP.  Returns false if it would pass OEND. */
+static bool put_len(uint8_t **op, const uint8_t *oend, size_t len)
+{
+	for(;;)
+	{
+		if(*op >= oend)
+			return false;
+		if(len < 255)
+		{
+			*(*op)++ = len;
+			return true;
+		}
+		*(*op)++ = 255;
+		len -= 255;
+	}
+}
+
+/* Adds the length bytes at *IP to *LEN, advancing *IP.  Returns
+	 false if they run past IEND. */
+static bool get_len(const uint8_t **ip, const uint8_t *iend, size_t *len)
+{
+	for(;;)
+	{
+		unsigned b;
+
+		if(*ip >= iend)
+			return false;
+		b = *(*ip)++;
+		*len += b;
+		if(b < 255)
+			return true;
+	}
+}
@@ -0,0 +1,10 @@
+#ifndef VM_LZ_H
+#define VM_LZ_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+size_t lz_compress(const void *src, size_t size, void *dst, size_t max);
+bool lz_decompress(const void *src, size_t size, void *dst, size_t dst_size);
+
+#endif /* vm/lz.h */
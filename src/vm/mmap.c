@@ -0,0 +1,151 @@
+#include "vm/mmap.h"
+#include <list.h>
+#include <round.h>
+#include <stddef.h>
+#include "vm/page.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/pagedir.h"
+
+/* Memory-mapped files.
+
+	 Mapping a file only records one PAGE_MMAP entry per page in
+	 the supplemental page table; the pages are read from the file
+	 on first touch like any other.  A page is written back only if
+	 its dirty bit is set when it is evicted or unmapped, and every
+	 mapping is unmapped when its process exits. */
+
+/* A file mapping. */
+struct mapping
+{
+	mapid_t id;								/* Mapping identifier. */
+	struct file *file;				/* Private reopened file. */
+	uint8_t *addr;						/* First mapped page. */
+	size_t page_cnt;					/* Number of mapped pages. */
+	struct list_elem elem;		/* Element in the thread's `mmap_list'. */
+};
+
+extern struct lock filesys_lock;
+
+static struct mapping *mapping_lookup(mapid_t mapid);
+static void unmap_pages(uint8_t *addr, size_t page_cnt);
+static void mapping_free(struct mapping *m);
+
+/* Maps FILE into the current process's address space starting at
+	 ADDR, which must be page-aligned.  Returns the new mapping's
+	 id, or MAP_FAILED if FILE is empty or the range overlaps pages
+	 already in use or the kernel. */
+mapid_t mmap_map(struct file *file, void *addr)
+{
+	struct thread *cur = thread_current();
+	struct mapping *m;
+	off_t length;
+	size_t i;
+
+	if(addr == NULL || pg_ofs(addr) != 0)
+		return MAP_FAILED;
+
+	m = malloc(sizeof *m);
+	if(m == NULL)
+		return MAP_FAILED;
+	lock_acquire(&filesys_lock);
+	m->file = file_reopen(file);
+	length = m->file != NULL ? file_length(m->file) : 0;
+	lock_release(&filesys_lock);
+	m->addr = addr;
+	m->page_cnt = DIV_ROUND_UP(length, PGSIZE);
+	if(length == 0
+		 || (uint8_t *) PHYS_BASE - m->addr < (ptrdiff_t) (m->page_cnt * PGSIZE))
+	{
+		mapping_free(m);
+		return MAP_FAILED;
+	}
+
+	/* Pages the kernel maps without recording them, such as the
+		 shared data page, are in use too. */
+	for(i = 0; i < m->page_cnt; i++)
+		if(pagedir_get_page(cur->pagedir, m->addr + i * PGSIZE) != NULL)
+		{
+			mapping_free(m);
+			return MAP_FAILED;
+		}
+
+	for(i = 0; i < m->page_cnt; i++)
+	{
+		off_t ofs = i * PGSIZE;
+		uint32_t read_bytes = length - ofs < PGSIZE ? length - ofs : PGSIZE;
+
+		if(!page_add_mmap(m->addr + ofs, m->file, ofs, read_bytes))
+		{
+			unmap_pages(m->addr, i);
+			mapping_free(m);
+			return MAP_FAILED;
+		}
+	}
+
+	m->id = cur->next_mapid++;
+	list_push_back(&cur->mmap_list, &m->elem);
+	return m->id;
+}
+
+/* Unmaps the current process's mapping MAPID, writing its dirty
+	 pages back to the file. */
+void mmap_unmap(mapid_t mapid)
+{
+	struct mapping *m = mapping_lookup(mapid);
+
+	if(m == NULL)
+		return;
+	unmap_pages(m->addr, m->page_cnt);
+	list_remove(&m->elem);
+	mapping_free(m);
+}
+
+/* Unmaps all of the current process's mappings, writing their
+	 dirty pages back to their files.  Called at process exit while
+	 the page directory is still active, so that a parent woken by
+	 the exit sees the data. */
+void mmap_destroy(void)
+{
+	struct list *mmaps = &thread_current()->mmap_list;
+
+	while(!list_empty(mmaps))
+	{
+		struct mapping *m = list_entry(list_pop_front(mmaps), struct mapping, elem);
+		unmap_pages(m->addr, m->page_cnt);
+		mapping_free(m);
+	}
+}
+
+static struct mapping *mapping_lookup(mapid_t mapid)
+{
+	struct list *mmaps = &thread_current()->mmap_list;
+	struct list_elem *e;
+
+	for(e = list_begin(mmaps); e != list_end(mmaps); e = list_next(e))
+	{
+		struct mapping *m = list_entry(e, struct mapping, elem);
+		if(m->id == mapid)
+			return m;
+	}
+	return NULL;
+}
+
+/* Removes the PAGE_CNT pages starting at ADDR. */
+static void unmap_pages(uint8_t *addr, size_t page_cnt)
+{
+	size_t i;
+
+	for(i = 0; i < page_cnt; i++)
+		page_remove(page_lookup(addr + i * PGSIZE));
+}
+
+static void mapping_free(struct mapping *m)
+{
+	lock_acquire(&filesys_lock);
+	file_close(m->file);
+	lock_release(&filesys_lock);
+	free(m);
+}
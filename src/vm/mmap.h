@@ -0,0 +1,14 @@
+#ifndef VM_MMAP_H
+#define VM_MMAP_H
+
+#include "filesys/file.h"
+
+/* Map region identifier. */
+typedef int mapid_t;
+#define MAP_FAILED ((mapid_t) -1)
+
+mapid_t mmap_map(struct file *file, void *addr);
+void mmap_unmap(mapid_t mapid);
+void mmap_destroy(void);
+
+#endif /* vm/mmap.h */
@@ -1 +1,681 @@
 #include "vm/page.h"
+#include <debug.h>
+#include <madvise.h>
+#include <round.h>
+#include <string.h>
+#include "vm/frame.h"
+#include "vm/ksm.h"
+#include "vm/swap.h"
+#include "filesys/file.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/pagedir.h"
+#include "userprog/shared-data.h"
+
+/* Supplemental page table.
+
+	 Each process keeps a hash of sup_page_table_entry keyed by
+	 user page.  Loading an executable or growing the address
+	 space only records pages here; page_load() brings a page into
+	 a frame the first time it is touched, from wherever its entry
+	 says it lives, and the frame table sends it back there with
+	 page_unmap() and page_write_out() when its frame is reclaimed.
+
+	 A page that has ever been dirtied, or has been read back from
+	 swap, has no copy anywhere but its frame, so it always goes to
+	 swap.  A clean page that came from a file or was all zeros is
+	 simply dropped and read again the next time.  Pages of a
+	 memory-mapped file are the exception: they go back to their
+	 file, and only if they are dirty.
+
+	 A page that vm/ksm.c has merged with identical pages has no
+	 frame of its own but is mapped read-only to a shared one.
+	 Writing to it loads a private copy of the shared frame.
+
+	 madvise() can change how a range of pages is treated: no
+	 read-ahead for MADV_RANDOM pages, the largest read-ahead window
+	 at once for MADV_SEQUENTIAL pages, whose frames are also marked
+	 for early eviction once the process has moved past them, so
+	 that a scan replaces its own pages rather than other
+	 processes'. */
+
+extern struct lock filesys_lock;
+
+/* Largest size, in bytes, to which a user stack may grow.  Set
+	 with the -stack kernel command line option. */
+size_t page_stack_max = STACK_MAX_DEFAULT;
+
+/* Fault-around and read-ahead.  A fault on a file-backed page
+	 that doesn't continue a sequential stream also loads the rest
+	 of the FAULT_AROUND-page aligned block around it.  A fault
+	 that does continue one, on the page just past the previous
+	 batch, doubles the stream's window, up to READAHEAD_MAX pages,
+	 and loads that many pages from the fault onward.  Extra pages
+	 only take frames that are free: read-ahead never evicts. */
+#define FAULT_AROUND 4
+#define READAHEAD_MAX 32
+
+/* How many pages behind a fault on an MADV_SEQUENTIAL page the
+	 pages marked for early eviction start. */
+#define DROP_BEHIND 4
+
+/* How far below esp an access may still be a push.  PUSHA
+	 checks 32 bytes below esp before storing anything. */
+#define STACK_SLOP 32
+
+static hash_hash_func page_hash;
+static hash_less_func page_less;
+static hash_action_func page_destroy;
+static struct sup_page_table_entry *page_add(void *upage, bool writable);
+static bool page_read(struct sup_page_table_entry *spte, void *kpage);
+static bool load(struct sup_page_table_entry *spte, bool evict);
+static void release(struct sup_page_table_entry *spte, uint32_t *pd);
+static size_t read_around(struct sup_page_table_entry *spte);
+static void drop_behind(uint8_t *upage, size_t cnt);
+static void discard(struct sup_page_table_entry *spte, uint32_t *pd);
+static bool map_zero(struct sup_page_table_entry *spte, uint32_t *pd);
+static bool pin(void *upage, bool write);
+static struct page_stream *stream_get(struct file *file);
+
+/* Read-only frame of zeros shared by every untouched PAGE_ZERO
+	 page.  Writing to such a page faults, and the fault gives the
+	 page a frame of its own. */
+static void *zero_page;
+
+/* Initializes the supplemental page table module. */
+void page_init(void)
+{
+	zero_page = palloc_get_page(PAL_ASSERT | PAL_ZERO);
+}
+
+/* Initializes SPT as an empty supplemental page table. */
+bool sup_table_init(struct hash *spt)
+{
+	return hash_init(spt, page_hash, page_less, NULL);
+}
+
+/* Frees every page in SPT in a single pass, along with the frame
+	 or swap slot holding it, and clears its mapping in PD.  PD
+	 must not be the active page directory, so that clearing a
+	 mapping does not flush the TLB. */
+void sup_table_destroy(struct hash *spt, uint32_t *pd)
+{
+	spt->aux = pd;
+	hash_destroy(spt, page_destroy);
+	frame_reclaimed();
+}
+
+/* Returns the current process's entry for UPAGE, or NULL if it
+	 has none. */
+struct sup_page_table_entry *page_lookup(const void *upage)
+{
+	struct sup_page_table_entry key;
+	struct hash_elem *e;
+
+	key.upage = (void *) upage;
+	e = hash_find(&thread_current()->spt, &key.elem);
+	return e != NULL ? hash_entry(e, struct sup_page_table_entry, elem) : NULL;
+}
+
+/* Records UPAGE as holding READ_BYTES bytes of FILE starting at
+	 OFS, followed by zeros.  Returns false if UPAGE is already
+	 recorded or memory is short. */
+bool page_add_file(void *upage, struct file *file, off_t ofs,
+									 uint32_t read_bytes, bool writable)
+{
+	struct sup_page_table_entry *spte;
+
+	ASSERT(read_bytes <= PGSIZE);
+
+	if(read_bytes == 0)
+		return page_add_zero(upage, writable);
+	spte = page_add(upage, writable);
+	if(spte == NULL)
+		return false;
+	spte->type = PAGE_FILE;
+	spte->file = file;
+	spte->ofs = ofs;
+	spte->read_bytes = read_bytes;
+	return true;
+}
+
+/* Records UPAGE as an all-zero page.  Returns false if UPAGE is
+	 already recorded or memory is short. */
+bool page_add_zero(void *upage, bool writable)
+{
+	return page_add(upage, writable) != NULL;
+}
+
+/* Records UPAGE as holding READ_BYTES bytes of memory-mapped
+	 FILE starting at OFS, followed by zeros.  Returns false if
+	 UPAGE is already recorded or memory is short. */
+bool page_add_mmap(void *upage, struct file *file, off_t ofs,
+									 uint32_t read_bytes)
+{
+	struct sup_page_table_entry *spte;
+
+	ASSERT(read_bytes > 0 && read_bytes <= PGSIZE);
+
+	spte = page_add(upage, true);
+	if(spte == NULL)
+		return false;
+	spte->type = PAGE_MMAP;
+	spte->file = file;
+	spte->ofs = ofs;
+	spte->read_bytes = read_bytes;
+	return true;
+}
+
+/* Removes SPTE, a page of the current process, from its address
+	 space, writing it back first if it is a dirty mapped page. */
+void page_remove(struct sup_page_table_entry *spte)
+{
+	struct thread *cur = thread_current();
+
+	release(spte, cur->pagedir);
+	hash_delete(&cur->spt, &spte->elem);
+	free(spte);
+}
+
+/* Makes UPAGE, a page of the current process, accessible, for
+	 writing if WRITE is true, bringing it into a frame if needed.
+	 An untouched all-zero page that is only read gets the shared
+	 zero page instead of a frame.  Returns true if UPAGE is mapped
+	 afterward, false if the process has no such page, it is
+	 read-only and WRITE is true, or it could not be loaded. */
+bool page_load(void *upage, bool write)
+{
+	struct sup_page_table_entry *spte = page_lookup(upage);
+	uint32_t *pd = thread_current()->pagedir;
+	size_t cnt;
+
+	if(spte == NULL || (write && !spte->writable))
+		return false;
+
+	if(spte->zero_mapped)
+	{
+		if(!write)
+			return true;
+		pagedir_clear_page(pd, upage);
+		spte->zero_mapped = false;
+	}
+	else if(!write && map_zero(spte, pd))
+		return true;
+	else if(pagedir_get_page(pd, upage) != NULL
+					&& (spte->ksm == NULL || !write))
+		return true;
+
+	if(!load(spte, true))
+		return false;
+	cnt = 1;
+	if((spte->type == PAGE_FILE || spte->type == PAGE_MMAP)
+		 && spte->advice != MADV_RANDOM)
+		cnt = read_around(spte);
+	if(spte->advice == MADV_SEQUENTIAL)
+		drop_behind(upage, cnt);
+	return true;
+}
+
+/* Applies ADVICE, one of the MADV_* values in <madvise.h>, to the
+	 current process's pages spanning the SIZE bytes at ADDR, which
+	 must be page-aligned.  MADV_WILLNEED loads the pages into free
+	 frames, as read-ahead does.  MADV_DONTNEED frees their frames
+	 and swap slots, writing back dirty mapped pages; other pages
+	 read from their file again or are zero the next time they are
+	 touched.  Returns false, doing nothing, if ADVICE is unknown or
+	 the range includes a page the process doesn't have. */
+bool page_advise(void *addr, size_t size, int advice)
+{
+	uint32_t *pd = thread_current()->pagedir;
+	uint8_t *first = addr;
+	uint8_t *end = first + ROUND_UP(size, PGSIZE);
+	uint8_t *p;
+
+	if(pg_ofs(addr) != 0 || end < first || end > (uint8_t *) PHYS_BASE
+		 || advice < MADV_NORMAL || advice > MADV_DONTNEED)
+		return false;
+	for(p = first; p < end; p += PGSIZE)
+		if(page_lookup(p) == NULL)
+			return false;
+
+	for(p = first; p < end; p += PGSIZE)
+	{
+		struct sup_page_table_entry *spte = page_lookup(p);
+
+		switch(advice)
+		{
+			case MADV_WILLNEED:
+				/* Untouched zero pages need no loading. */
+				if(spte->kpage == NULL && spte->ksm == NULL && !spte->zero_mapped
+					 && spte->type != PAGE_ZERO)
+					load(spte, false);
+				break;
+
+			case MADV_DONTNEED:
+				discard(spte, pd);
+				break;
+
+			default:
+				spte->advice = advice;
+				break;
+		}
+	}
+	return true;
+}
+
+/* Makes the pages of the current process spanning the SIZE
+	 bytes at BUFFER resident, for writing if WRITE is true, and
+	 pins them there until page_unpin_buffer(), so that the kernel
+	 can use BUFFER without faulting.  A writable page gets a frame
+	 of its own even if WRITE is false: otherwise the process could
+	 move it to a new frame by writing to it meanwhile.  Returns
+	 false, with nothing pinned, if some page can't be loaded. */
+bool page_pin_buffer(const void *buffer, size_t size, bool write)
+{
+	uint8_t *first = pg_round_down(buffer);
+	const uint8_t *end = (const uint8_t *) buffer + size;
+	uint8_t *p;
+
+	for(p = first; p < end; p += PGSIZE)
+		if(!pin(p, write))
+		{
+			page_unpin_buffer(thread_current()->pagedir, first, p - first);
+			return false;
+		}
+	return true;
+}
+
+/* Drops the pins page_pin_buffer() took on the pages spanning
+	 the SIZE bytes at BUFFER, mapped in PD. */
+void page_unpin_buffer(uint32_t *pd, const void *buffer, size_t size)
+{
+	uint8_t *p = pg_round_down(buffer);
+	const uint8_t *end = (const uint8_t *) buffer + size;
+
+	for(; p < end; p += PGSIZE)
+	{
+		void *kpage = pagedir_get_page(pd, p);
+
+		ASSERT(kpage != NULL);
+		if(kpage != zero_page)
+			frame_unpin(kpage);
+	}
+}
+
+/* Grows the current process's stack to cover ADDR, if ADDR is
+	 within the stack size limit and no further below ESP, the
+	 process's stack pointer, than a push instruction reaches.
+	 Returns true if ADDR is mapped afterward. */
+bool page_grow_stack(const void *addr, const void *esp)
+{
+	const uint8_t *p = addr;
+	void *upage;
+
+	if(p >= (uint8_t *) PHYS_BASE
+		 || p < (uint8_t *) PHYS_BASE - page_stack_max
+		 || p + STACK_SLOP < (const uint8_t *) esp)
+		return false;
+
+	upage = pg_round_down(addr);
+	return page_add_zero(upage, true) && page_load(upage, true);
+}
+
+/* Unmaps SPTE, which is resident and mapped in PD, so that its
+	 frame can be reclaimed.  Returns true if its contents must be
+	 written out first, with page_write_out(): to its file if it is
+	 a dirty mapped page, otherwise to swap.  Returns false if the
+	 page is no longer resident and its frame may be reused at
+	 once.  Called by the frame table with its lock held.  Writing
+	 out takes the file system lock, so the frame table does it
+	 with its own lock released. */
+bool page_unmap(struct sup_page_table_entry *spte, uint32_t *pd)
+{
+	/* Unmap first so that the owner can't modify the page while
+		 it is being written. */
+	pagedir_clear_page(pd, spte->upage);
+	if(pagedir_is_dirty(pd, spte->upage) || spte->type == PAGE_SWAP)
+		return true;
+	spte->kpage = NULL;
+	return false;
+}
+
+/* Returns true if page_unmap() might say SPTE, which is
+	 resident, must be written to swap.  A page for which this
+	 returns false can't be dirtied meanwhile. */
+bool page_may_swap(const struct sup_page_table_entry *spte)
+{
+	return spte->type != PAGE_MMAP
+		&& (spte->writable || spte->type == PAGE_SWAP);
+}
+
+/* Writes out the CNT pages in SPTES, at most SWAP_CLUSTER, which
+	 page_unmap() said need it and which belong to the processes in
+	 OWNERS: dirty mapped pages to their files, and the rest to swap
+	 together.  Called by the frame table without its lock, which
+	 then marks the pages no longer resident. */
+void page_write_out(struct sup_page_table_entry **sptes,
+										struct thread **owners, size_t cnt)
+{
+	struct sup_page_table_entry *swap_sptes[SWAP_CLUSTER];
+	struct thread *swap_owners[SWAP_CLUSTER];
+	size_t swap_cnt = 0;
+	size_t i;
+
+	ASSERT(cnt <= SWAP_CLUSTER);
+
+	for(i = 0; i < cnt; i++)
+		if(sptes[i]->type == PAGE_MMAP)
+			page_write_back(sptes[i]);
+		else
+		{
+			swap_sptes[swap_cnt] = sptes[i];
+			swap_owners[swap_cnt++] = owners[i];
+		}
+	if(swap_cnt == 0)
+		return;
+	swap_out(swap_sptes, swap_owners, swap_cnt);
+	for(i = 0; i < swap_cnt; i++)
+		swap_sptes[i]->type = PAGE_SWAP;
+}
+
+/* Writes SPTE, a resident page of a memory-mapped file, back to
+	 its file.  The caller must have unmapped the page, so that its
+	 owner can't modify it meanwhile, and must not hold the frame
+	 table lock. */
+void page_write_back(struct sup_page_table_entry *spte)
+{
+	lock_acquire(&filesys_lock);
+	file_write_at(spte->file, spte->kpage, spte->read_bytes, spte->ofs);
+	lock_release(&filesys_lock);
+}
+
+/* Records UPAGE as an all-zero page and returns its new entry,
+	 or NULL if UPAGE is already recorded, is the page the kernel
+	 shares with every process at SHARED_DATA_ADDR, or memory is
+	 short. */
+static struct sup_page_table_entry *page_add(void *upage, bool writable)
+{
+	struct sup_page_table_entry *spte;
+
+	ASSERT(pg_ofs(upage) == 0);
+	ASSERT(is_user_vaddr(upage));
+
+	if(upage == SHARED_DATA_ADDR)
+		return NULL;
+	spte = malloc(sizeof *spte);
+	if(spte == NULL)
+		return NULL;
+	spte->upage = upage;
+	spte->kpage = NULL;
+	spte->type = PAGE_ZERO;
+	spte->writable = writable;
+	spte->file = NULL;
+	spte->ofs = 0;
+	spte->read_bytes = 0;
+	spte->swap_slot = 0;
+	spte->zero_mapped = false;
+	spte->ksm = NULL;
+	spte->advice = MADV_NORMAL;
+	if(hash_insert(&thread_current()->spt, &spte->elem) != NULL)
+	{
+		free(spte);
+		return NULL;
+	}
+	return spte;
+}
+
+/* Loads SPTE, a page of the current process, into a frame and
+	 maps it.  If EVICT is false, fails rather than evict another
+	 page to make room. */
+static bool load(struct sup_page_table_entry *spte, bool evict)
+{
+	uint32_t *pd = thread_current()->pagedir;
+	struct ksm_page *k;
+	void *kpage;
+
+	/* An unmapped page that is still resident is being evicted
+		 right now, or the page merging thread cleared its mapping to
+		 compare it.  Allocating a frame waits for the eviction to
+		 finish, and hands back the page's own frame in the second
+		 case, once the page is mapped again. */
+	kpage = evict ? frame_alloc(PAL_USER, spte)
+		: frame_alloc_free(PAL_USER, spte);
+	if(kpage == NULL)
+		return false;
+	if(kpage == spte->kpage)
+	{
+		frame_unpin(kpage);
+		return true;
+	}
+
+	/* A merged page, perhaps merged while the frame was found,
+		 gets a copy of its shared frame.  Only a resident page can
+		 be merged, so SPTE->ksm can't change now. */
+	k = spte->ksm;
+	if(k != NULL)
+	{
+		memcpy(kpage, k->kpage, PGSIZE);
+		pagedir_clear_page(pd, spte->upage);
+	}
+	if((k == NULL && !page_read(spte, kpage))
+		 || !pagedir_set_page(pd, spte->upage, kpage, spte->writable))
+	{
+		frame_free(kpage);
+		return false;
+	}
+	if(k != NULL)
+	{
+		/* The copy may differ from what SPTE's backing store holds. */
+		pagedir_set_dirty(pd, spte->upage, true);
+		spte->ksm = NULL;
+		ksm_put(k);
+	}
+	spte->kpage = kpage;
+	frame_unpin(kpage);
+	return true;
+}
+
+/* Maps SPTE, a page of the current process, to the shared zero
+	 page in PD if it is an all-zero page that is neither in a
+	 frame nor merged, and returns true if it did.  Eviction and
+	 merging change all three of SPTE's `type', `kpage' and `ksm',
+	 so they are only consistent under the frame table lock: a page
+	 on its way to swap, for one, is already PAGE_SWAP but still
+	 has `kpage' set. */
+static bool map_zero(struct sup_page_table_entry *spte, uint32_t *pd)
+{
+	bool mapped = false;
+
+	frame_lock_acquire();
+	if(spte->type == PAGE_ZERO && spte->kpage == NULL && spte->ksm == NULL)
+		mapped = spte->zero_mapped
+			= pagedir_set_page(pd, spte->upage, zero_page, false);
+	frame_lock_release();
+	return mapped;
+}
+
+/* Implements page_pin_buffer() for one page, UPAGE.  A read-only
+	 page mapped to a shared frame stays there, unpinned: shared
+	 frames are never evicted, and the process can't write to the
+	 page to get a private copy. */
+static bool pin(void *upage, bool write)
+{
+	struct sup_page_table_entry *spte = page_lookup(upage);
+
+	if(spte == NULL)
+		return false;
+	write = write || spte->writable;
+
+	/* Eviction may take the page away again before it is pinned. */
+	for(;;)
+	{
+		if(!page_load(upage, write))
+			return false;
+		if(spte->zero_mapped || spte->ksm != NULL || frame_pin(spte) != NULL)
+			return true;
+	}
+}
+
+/* Having just loaded SPTE, a file-backed page, loads the pages of
+	 the same file around it or read ahead of it, as described at
+	 the top of this file.  Returns the number of pages from SPTE's
+	 onward that are now resident. */
+static size_t read_around(struct sup_page_table_entry *spte)
+{
+	struct page_stream *s = stream_get(spte->file);
+	uint8_t *upage = spte->upage;
+	uint8_t *first, *end, *p;
+
+	if(spte->advice == MADV_SEQUENTIAL || upage == s->next)
+	{
+		if(spte->advice == MADV_SEQUENTIAL)
+			s->window = READAHEAD_MAX;
+		else
+			s->window = s->window * 2 < READAHEAD_MAX ? s->window * 2 : READAHEAD_MAX;
+		first = upage;
+		end = upage + s->window * PGSIZE;
+	}
+	else
+	{
+		s->window = FAULT_AROUND;
+		first = (uint8_t *) ROUND_DOWN((uintptr_t) upage, FAULT_AROUND * PGSIZE);
+		end = first + FAULT_AROUND * PGSIZE;
+	}
+
+	for(p = first; p < end; p += PGSIZE)
+	{
+		struct sup_page_table_entry *n = page_lookup(p);
+
+		if(p == upage || (n != NULL && (n->kpage != NULL || n->ksm != NULL)))
+			continue;
+		if(n == NULL || n->file != spte->file
+			 || (n->type != PAGE_FILE && n->type != PAGE_MMAP)
+			 || !load(n, false))
+		{
+			if(p > upage)
+				break;
+		}
+	}
+	s->next = p;
+	return (p - upage) / PGSIZE;
+}
+
+/* Having just faulted in the CNT pages at UPAGE, marks as many
+	 MADV_SEQUENTIAL pages, ending DROP_BEHIND pages before UPAGE,
+	 for early eviction. */
+static void drop_behind(uint8_t *upage, size_t cnt)
+{
+	size_t i;
+
+	for(i = DROP_BEHIND + 1; i <= DROP_BEHIND + cnt; i++)
+	{
+		struct sup_page_table_entry *spte;
+
+		if((uintptr_t) upage < i * PGSIZE)
+			break;
+		spte = page_lookup(upage - i * PGSIZE);
+		if(spte != NULL && spte->advice == MADV_SEQUENTIAL)
+			frame_demote(spte);
+	}
+}
+
+/* Throws away SPTE's contents, freeing its frame or swap slot.
+	 A dirty mapped page is written back first.  Other pages are
+	 read from their file or zero the next time. */
+static void discard(struct sup_page_table_entry *spte, uint32_t *pd)
+{
+	release(spte, pd);
+	spte->zero_mapped = false;
+	if(spte->type == PAGE_SWAP)
+		spte->type = spte->file != NULL ? PAGE_FILE : PAGE_ZERO;
+}
+
+/* Returns the current process's fault stream for FILE, taking
+	 over the least recently started one if FILE has none. */
+static struct page_stream *stream_get(struct file *file)
+{
+	struct thread *cur = thread_current();
+	struct page_stream *s;
+	size_t i;
+
+	for(i = 0; i < PAGE_STREAMS; i++)
+		if(cur->streams[i].file == file)
+			return &cur->streams[i];
+
+	s = &cur->streams[cur->next_stream++ % PAGE_STREAMS];
+	s->file = file;
+	s->next = NULL;
+	s->window = 0;
+	return s;
+}
+
+/* Fills KPAGE with the contents SPTE describes. */
+static bool page_read(struct sup_page_table_entry *spte, void *kpage)
+{
+	switch(spte->type)
+	{
+		case PAGE_ZERO:
+			memset(kpage, 0, PGSIZE);
+			return true;
+
+		case PAGE_FILE:
+		case PAGE_MMAP:
+		{
+			off_t n;
+
+			lock_acquire(&filesys_lock);
+			n = file_read_at(spte->file, kpage, spte->read_bytes, spte->ofs);
+			lock_release(&filesys_lock);
+			if(n != (off_t) spte->read_bytes)
+				return false;
+			memset((uint8_t *) kpage + spte->read_bytes, 0,
+						 PGSIZE - spte->read_bytes);
+			return true;
+		}
+
+		case PAGE_SWAP:
+			swap_in(spte, kpage);
+			return true;
+	}
+	NOT_REACHED();
+}
+
+static unsigned page_hash(const struct hash_elem *e, void *aux UNUSED)
+{
+	const struct sup_page_table_entry *spte
+		= hash_entry(e, struct sup_page_table_entry, elem);
+	return hash_int((int) pg_no(spte->upage));
+}
+
+static bool page_less(const struct hash_elem *a, const struct hash_elem *b,
+											void *aux UNUSED)
+{
+	return hash_entry(a, struct sup_page_table_entry, elem)->upage
+		< hash_entry(b, struct sup_page_table_entry, elem)->upage;
+}
+
+/* Frees the page at E; AUX is its process's page directory. */
+static void page_destroy(struct hash_elem *e, void *aux)
+{
+	struct sup_page_table_entry *spte
+		= hash_entry(e, struct sup_page_table_entry, elem);
+	uint32_t *pd = aux;
+
+	release(spte, pd);
+	free(spte);
+}
+
+/* Removes SPTE's mapping from PD and frees the frame or swap slot
+	 holding it, writing it back first if it is a dirty mapped
+	 page. */
+static void release(struct sup_page_table_entry *spte, uint32_t *pd)
+{
+	/* pagedir_destroy() would free the shared zero page. */
+	if(spte->zero_mapped)
+		pagedir_clear_page(pd, spte->upage);
+	else if(!frame_drop(spte, pd) && !ksm_drop(spte, pd)
+					&& spte->type == PAGE_SWAP)
+		swap_free(spte->swap_slot);
+}
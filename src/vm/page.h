@@ -1,24 +1,81 @@
 #ifndef VM_PAGE_H
 #define VM_PAGE_H
 
-#include <stdlib.h>
+#include <hash.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "filesys/off_t.h"
 
-enum addr_type
-{
-	FILE = 1;
-	SWAP = 2;
+struct ksm_page;
+struct thread;
 
+/* Where a page's contents come from when it is not in a frame. */
+enum page_type
+{
+	PAGE_ZERO,						/* All zeros. */
+	PAGE_FILE,						/* READ_BYTES bytes of FILE at OFS, then zeros. */
+	PAGE_MMAP,						/* Like PAGE_FILE, but written back to FILE. */
+	PAGE_SWAP							/* Swap slot SWAP_SLOT. */
 };
 
+/* Supplemental page table entry: everything the kernel knows
+	 about one page of a process's virtual address space beyond
+	 what the hardware page table holds. */
 struct sup_page_table_entry
 {
-	enum type;
-	void *uaddr;
+	void *upage;											/* User virtual page. */
+	void *kpage;											/* Frame holding the page, or NULL. */
+	enum page_type type;							/* Backing store when not resident. */
+	bool writable;										/* Writable by the user process? */
+
+	struct file *file;								/* PAGE_FILE/MMAP: file to read from. */
+	off_t ofs;												/* PAGE_FILE/MMAP: offset in FILE. */
+	uint32_t read_bytes;							/* PAGE_FILE/MMAP: bytes to read, rest zero. */
 
+	size_t swap_slot;									/* PAGE_SWAP: slot holding the page. */
+	bool zero_mapped;									/* Mapped to the shared zero page? */
+	struct ksm_page *ksm;							/* Merged frame mapped, or NULL. */
+	uint8_t advice;										/* MADV_NORMAL, _RANDOM or _SEQUENTIAL. */
+
+	struct hash_elem elem;						/* Element in the thread's `spt'. */
 };
 
-void sup_table_init();
-void sup_table_destroy();
+/* Number of fault streams tracked per process for read-ahead. */
+#define PAGE_STREAMS 4
+
+/* Recent faults on one file, for read-ahead. */
+struct page_stream
+{
+	struct file *file;								/* File, or NULL if unused. */
+	void *next;												/* Page a sequential fault would hit. */
+	size_t window;										/* Current read-ahead window in pages. */
+};
+
+/* Default and current limit on the size of a user stack. */
+#define STACK_MAX_DEFAULT (8 * 1024 * 1024)
+extern size_t page_stack_max;
+
+void page_init(void);
+bool sup_table_init(struct hash *spt);
+void sup_table_destroy(struct hash *spt, uint32_t *pd);
 
+struct sup_page_table_entry *page_lookup(const void *upage);
+bool page_add_file(void *upage, struct file *file, off_t ofs,
+									 uint32_t read_bytes, bool writable);
+bool page_add_zero(void *upage, bool writable);
+bool page_add_mmap(void *upage, struct file *file, off_t ofs,
+									 uint32_t read_bytes);
+void page_remove(struct sup_page_table_entry *spte);
+bool page_load(void *upage, bool write);
+bool page_advise(void *addr, size_t size, int advice);
+bool page_pin_buffer(const void *buffer, size_t size, bool write);
+void page_unpin_buffer(uint32_t *pd, const void *buffer, size_t size);
+bool page_grow_stack(const void *addr, const void *esp);
+bool page_unmap(struct sup_page_table_entry *spte, uint32_t *pd);
+bool page_may_swap(const struct sup_page_table_entry *spte);
+void page_write_out(struct sup_page_table_entry **sptes,
+										struct thread **owners, size_t cnt);
+void page_write_back(struct sup_page_table_entry *spte);
 
-#endif /* vm/page.h */
\ No newline at end of file
+#endif /* vm/page.h */
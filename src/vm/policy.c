@@ -0,0 +1,350 @@
+#include "vm/policy.h"
+#include <debug.h>
+#include <list.h>
+#include <string.h>
+#include "vm/frame.h"
+#include "threads/malloc.h"
+
+/* Page replacement policies.
+
+	 None of the hardware's help is finer than the accessed bit, so
+	 every policy learns about references by testing and clearing
+	 it with frame_referenced() while it looks for a victim:
+
+	 - "clock" sweeps the table, giving each frame referenced since
+		 the last sweep a second chance.
+
+	 - "fifo" evicts frames in the order they were filled.
+
+	 - "lru-k" is LRU-2.  Each search first samples every frame's
+		 accessed bit, recording a reference at the current search
+		 count, then evicts the frame whose second most recent
+		 reference is oldest.  Frames referenced only once go first.
+
+	 - "2q" keeps newly loaded pages in a FIFO, A1in, and pages
+		 loaded again soon after leaving it in an LRU queue, Am.
+		 A1out remembers the pages most recently evicted from A1in.
+		 Pages touched once, as by a scan, pass through A1in without
+		 pushing the working set in Am out.
+
+	 Which one is used is set with the -vm-policy kernel command
+	 line option. */
+
+/* Per-frame list membership, for the policies that keep lists. */
+struct frame_node
+{
+	struct list_elem elem;						/* Element in a policy list. */
+	struct list *list;								/* List ELEM is in, or NULL. */
+};
+
+static struct frame_node *nodes;
+static size_t node_cnt;
+
+static bool nodes_init(size_t frame_cnt);
+static void node_push(size_t idx, struct list *list);
+static void node_push_front(size_t idx, struct list *list);
+static void node_remove(size_t idx);
+static size_t node_idx(struct list_elem *e);
+static size_t first_evictable(struct list *list);
+
+/* Clock. */
+
+static size_t clock_hand;
+
+static void clock_init(size_t frame_cnt)
+{
+	node_cnt = frame_cnt;
+	clock_hand = 0;
+}
+
+static void clock_insert(size_t idx UNUSED,
+												 const struct sup_page_table_entry *spte UNUSED)
+{
+}
+
+static void clock_remove(size_t idx UNUSED)
+{
+}
+
+static void clock_demote(size_t idx UNUSED)
+{
+	/* With its accessed bit clear, the hand takes it next time by. */
+}
+
+static size_t clock_victim(void)
+{
+	size_t i;
+
+	for(i = 0; i < 2 * node_cnt; i++)
+	{
+		size_t idx = clock_hand;
+
+		clock_hand = (clock_hand + 1) % node_cnt;
+		if(frame_evictable(idx) && !frame_referenced(idx))
+			return idx;
+	}
+	return FRAME_NONE;
+}
+
+/* FIFO. */
+
+static struct list fifo_queue;
+
+static void fifo_init(size_t frame_cnt)
+{
+	list_init(&fifo_queue);
+	if(!nodes_init(frame_cnt))
+		PANIC("could not allocate fifo policy");
+}
+
+static void fifo_insert(size_t idx,
+												const struct sup_page_table_entry *spte UNUSED)
+{
+	node_push(idx, &fifo_queue);
+}
+
+static void fifo_remove(size_t idx)
+{
+	node_remove(idx);
+}
+
+static void fifo_demote(size_t idx)
+{
+	node_push_front(idx, &fifo_queue);
+}
+
+static size_t fifo_victim(void)
+{
+	return first_evictable(&fifo_queue);
+}
+
+/* LRU-2. */
+
+#define LRU_K 2
+
+/* Search count at each frame's last LRU_K references, most
+	 recent first, or 0 for none. */
+static uint64_t (*lru_hist)[LRU_K];
+static uint64_t lru_now;
+
+static void lru_init(size_t frame_cnt)
+{
+	node_cnt = frame_cnt;
+	lru_hist = calloc(frame_cnt, sizeof *lru_hist);
+	if(lru_hist == NULL && frame_cnt > 0)
+		PANIC("could not allocate lru-k policy");
+}
+
+static void lru_insert(size_t idx,
+											 const struct sup_page_table_entry *spte UNUSED)
+{
+	/* Loading the page was a reference. */
+	memset(lru_hist[idx], 0, sizeof lru_hist[idx]);
+	lru_hist[idx][0] = ++lru_now;
+}
+
+static void lru_remove(size_t idx UNUSED)
+{
+}
+
+static void lru_demote(size_t idx)
+{
+	/* Never referenced goes first. */
+	memset(lru_hist[idx], 0, sizeof lru_hist[idx]);
+}
+
+static size_t lru_victim(void)
+{
+	size_t best = FRAME_NONE;
+	size_t idx;
+
+	lru_now++;
+	for(idx = 0; idx < node_cnt; idx++)
+		if(frame_referenced(idx))
+		{
+			memmove(&lru_hist[idx][1], &lru_hist[idx][0],
+							(LRU_K - 1) * sizeof lru_hist[idx][0]);
+			lru_hist[idx][0] = lru_now;
+		}
+
+	for(idx = 0; idx < node_cnt; idx++)
+		if(frame_evictable(idx)
+			 && (best == FRAME_NONE
+					 || lru_hist[idx][LRU_K - 1] < lru_hist[best][LRU_K - 1]
+					 || (lru_hist[idx][LRU_K - 1] == lru_hist[best][LRU_K - 1]
+							 && lru_hist[idx][0] < lru_hist[best][0])))
+			best = idx;
+	return best;
+}
+
+/* 2Q. */
+
+static struct list a1in, am;
+static size_t a1in_cnt, a1in_max;
+
+/* A1out: the pages, identified by supplemental page table entry,
+	 most recently evicted from A1in.  An entry may be stale, which
+	 at worst sends a page to Am undeservedly. */
+static const struct sup_page_table_entry **a1out;
+static size_t a1out_max, a1out_next;
+
+static void twoq_init(size_t frame_cnt)
+{
+	list_init(&a1in);
+	list_init(&am);
+	a1in_cnt = 0;
+	a1in_max = frame_cnt / 4 > 1 ? frame_cnt / 4 : 1;
+	a1out_max = frame_cnt / 2 > 1 ? frame_cnt / 2 : 1;
+	a1out = calloc(a1out_max, sizeof *a1out);
+	if(!nodes_init(frame_cnt) || a1out == NULL)
+		PANIC("could not allocate 2q policy");
+}
+
+static void twoq_insert(size_t idx, const struct sup_page_table_entry *spte)
+{
+	size_t i;
+
+	for(i = 0; i < a1out_max; i++)
+		if(a1out[i] == spte)
+		{
+			a1out[i] = NULL;
+			node_push(idx, &am);
+			return;
+		}
+	node_push(idx, &a1in);
+	a1in_cnt++;
+}
+
+static void twoq_remove(size_t idx)
+{
+	if(nodes[idx].list == &a1in)
+		a1in_cnt--;
+	node_remove(idx);
+}
+
+static void twoq_demote(size_t idx)
+{
+	/* Evicted first from whichever queue it is in. */
+	node_push_front(idx, nodes[idx].list);
+}
+
+static size_t twoq_victim(void)
+{
+	size_t idx;
+
+	/* Move Am's referenced frames to its most recently used end,
+		 leaving the others in order ahead of them.  Frames moved go
+		 behind the last one there now, so each is looked at once. */
+	if(!list_empty(&am))
+	{
+		struct list_elem *last = list_back(&am);
+		struct list_elem *e, *next;
+
+		for(e = list_begin(&am); ; e = next)
+		{
+			next = list_next(e);
+			idx = node_idx(e);
+			if(frame_referenced(idx))
+				node_push(idx, &am);
+			if(e == last)
+				break;
+		}
+	}
+
+	idx = FRAME_NONE;
+	if(a1in_cnt > a1in_max)
+		idx = first_evictable(&a1in);
+	if(idx == FRAME_NONE)
+		idx = first_evictable(&am);
+	if(idx == FRAME_NONE)
+		idx = first_evictable(&a1in);
+
+	if(idx != FRAME_NONE && nodes[idx].list == &a1in)
+	{
+		struct sup_page_table_entry *spte;
+		uint32_t *pd;
+
+		frame_owner(idx, &spte, &pd);
+		a1out[a1out_next] = spte;
+		a1out_next = (a1out_next + 1) % a1out_max;
+	}
+	return idx;
+}
+
+static const struct frame_policy policies[] =
+{
+	{"clock", clock_init, clock_insert, clock_remove, clock_demote,
+	 clock_victim},
+	{"fifo", fifo_init, fifo_insert, fifo_remove, fifo_demote, fifo_victim},
+	{"lru-k", lru_init, lru_insert, lru_remove, lru_demote, lru_victim},
+	{"2q", twoq_init, twoq_insert, twoq_remove, twoq_demote, twoq_victim},
+};
+
+/* Policy in use. */
+const struct frame_policy *frame_policy = &policies[0];
+
+/* Selects the policy called NAME.  Returns false if there is no
+	 such policy. */
+bool policy_select(const char *name)
+{
+	size_t i;
+
+	for(i = 0; i < sizeof policies / sizeof *policies; i++)
+		if(!strcmp(policies[i].name, name))
+		{
+			frame_policy = &policies[i];
+			return true;
+		}
+	return false;
+}
+
+/* Allocates a node for each of FRAME_CNT frames. */
+static bool nodes_init(size_t frame_cnt)
+{
+	node_cnt = frame_cnt;
+	nodes = calloc(frame_cnt, sizeof *nodes);
+	return nodes != NULL || frame_cnt == 0;
+}
+
+/* Moves frame IDX to the back of LIST. */
+static void node_push(size_t idx, struct list *list)
+{
+	node_remove(idx);
+	list_push_back(list, &nodes[idx].elem);
+	nodes[idx].list = list;
+}
+
+/* Moves frame IDX to the front of LIST. */
+static void node_push_front(size_t idx, struct list *list)
+{
+	node_remove(idx);
+	list_push_front(list, &nodes[idx].elem);
+	nodes[idx].list = list;
+}
+
+/* Takes frame IDX off its list, if any. */
+static void node_remove(size_t idx)
+{
+	if(nodes[idx].list != NULL)
+	{
+		list_remove(&nodes[idx].elem);
+		nodes[idx].list = NULL;
+	}
+}
+
+/* Returns the frame whose node contains E. */
+static size_t node_idx(struct list_elem *e)
+{
+	return list_entry(e, struct frame_node, elem) - nodes;
+}
+
+/* Returns the first evictable frame in LIST, or FRAME_NONE. */
+static size_t first_evictable(struct list *list)
+{
+	struct list_elem *e;
+
+	for(e = list_begin(list); e != list_end(list); e = list_next(e))
+		if(frame_evictable(node_idx(e)))
+			return node_idx(e);
+	return FRAME_NONE;
+}
@@ -0,0 +1,42 @@
+#ifndef VM_POLICY_H
+#define VM_POLICY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct sup_page_table_entry;
+
+/* A page replacement policy: decides which frame the frame table
+	 evicts next.  The frame table calls every function with its
+	 lock held. */
+struct frame_policy
+{
+	const char *name;									/* Name on the command line. */
+
+	/* Sets up for a table of FRAME_CNT frames. */
+	void (*init)(size_t frame_cnt);
+
+	/* Frame IDX now holds SPTE's page. */
+	void (*insert)(size_t idx, const struct sup_page_table_entry *spte);
+
+	/* Frame IDX no longer holds a page. */
+	void (*remove)(size_t idx);
+
+	/* Frame IDX's page won't be needed soon and should be evicted
+		 early.  Its accessed bit has been cleared. */
+	void (*demote)(size_t idx);
+
+	/* Returns a frame that frame_evictable() accepts, to be evicted
+		 next, or FRAME_NONE if there is none. */
+	size_t (*victim)(void);
+};
+
+/* No frame. */
+#define FRAME_NONE SIZE_MAX
+
+extern const struct frame_policy *frame_policy;
+
+bool policy_select(const char *name);
+
+#endif /* vm/policy.h */
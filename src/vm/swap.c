@@ -1,60 +1,302 @@
 #include "vm/swap.h"
+#include <bitmap.h>
+#include <debug.h>
+#include <madvise.h>
+#include <stdio.h>
+#include <string.h>
+#include "vm/page.h"
+#include "vm/zswap.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
 
-void swap_init()
+/* Swap slots.
+
+	 The swap device is divided into page-sized slots.  Slots are
+	 handed out next-fit, continuing from just past the previous
+	 allocation, so that pages evicted together land in one
+	 contiguous run that is written with a single multi-sector
+	 transfer.
+
+	 Pages a process evicted together tend to be needed together,
+	 so swap_in() reads the following slots too, as long as they
+	 belong to the same process, and keeps them in a small
+	 read-ahead buffer for the faults that follow.  Pages the
+	 process marked MADV_RANDOM are read alone.
+
+	 Pages that compress well don't reach the device at all while
+	 vm/zswap.c has room for them: swap_out() still gives each page
+	 a slot, but only writes the pages the cache turned away, and
+	 swap_in() checks the cache before reading.
+
+	 The frame table reserves a slot with swap_reserve() before it
+	 picks a page that may need one, so that swap_out() never runs
+	 out of slots halfway through a batch. */
+
+/* Most pages read from swap in one transfer. */
+#define SWAP_READAHEAD 8
+
+static struct lock swap_lock;
+
+static struct block *swap_block;
+
+/* A bitmap to store available frame (NOT available sector).
+	 bitmap(i) = true -> frame i is used.
+	 bitmap(i) = false -> frame i is free. */
+static struct bitmap *swap_used_map;
+static size_t swap_slot_cnt;		/* Number of slots. */
+static size_t swap_used_cnt;		/* Number of used slots. */
+static size_t swap_reserved;		/* Slots promised to swap_out(). */
+static size_t swap_hand;				/* Where the next allocation starts looking. */
+
+/* Page held by each used slot, for read-ahead. */
+static struct sup_page_table_entry **swap_owner;
+
+/* Staging buffer for clustered writes. */
+static uint8_t *cluster_buf;
+
+/* Read-ahead buffer: slot RA_FIRST + i is in page i if
+	 RA_VALID[i]. */
+static uint8_t *ra_buf;
+static size_t ra_first;
+static bool ra_valid[SWAP_READAHEAD];
+
+/* Statistics. */
+static size_t out_cnt, in_cnt;			/* Pages swapped out and in. */
+static size_t write_cnt, read_cnt;	/* Pages written to and read from disk. */
+
+static size_t slot_alloc(size_t cnt);
+static void write_run(struct sup_page_table_entry **sptes, size_t cnt);
+static void slot_release(size_t slot);
+static bool same_process(size_t slot);
+
+void swap_init(void)
 {
 	lock_init(&swap_lock);
 
 	swap_block = block_get_role(BLOCK_SWAP);
 	if(!swap_block) return;
 
-	int swap_size = block_size(swap_block/SECTOR_PER_PAGE);
-	swap_used_map = bitmap_create(swap_size);
-	if(!swap_used_map) return;
+	swap_slot_cnt = block_size(swap_block) / SECTOR_PER_PAGE;
+	swap_used_map = bitmap_create(swap_slot_cnt);
+	swap_owner = calloc(swap_slot_cnt, sizeof *swap_owner);
+	cluster_buf = palloc_get_multiple(0, SWAP_CLUSTER);
+	ra_buf = palloc_get_multiple(0, SWAP_READAHEAD);
+	if(!swap_used_map || !swap_owner || !cluster_buf || !ra_buf)
+		PANIC("could not initialize swap");
+	swap_hand = 0;
+	zswap_init(swap_block, swap_slot_cnt);
+}
+
+/* Returns true if there is a swap device to write pages to. */
+bool swap_available(void)
+{
+	return swap_used_map != NULL;
 }
 
-/* Swap in the frame starting at swap_index to addr. KERNEL PANIC if fail. */
-void swap_in(int swap_index, void *addr)
+/* Reserves a slot for a page that swap_out() will write.
+	 Returns false if swap is full or there is no swap device. */
+bool swap_reserve(void)
 {
+	bool ok;
+
+	lock_acquire(&swap_lock);
+	ok = swap_used_map != NULL
+		&& swap_used_cnt + swap_reserved < swap_slot_cnt;
+	if(ok)
+		swap_reserved++;
+	lock_release(&swap_lock);
+	return ok;
+}
+
+/* Cancels a reservation made with swap_reserve(). */
+void swap_unreserve(void)
+{
+	lock_acquire(&swap_lock);
+	ASSERT(swap_reserved > 0);
+	swap_reserved--;
+	lock_release(&swap_lock);
+}
+
+/* Reads the page SPTE, which is in swap, into KPAGE and frees its
+	 slot. */
+void swap_in(struct sup_page_table_entry *spte, void *kpage)
+{
+	size_t slot = spte->swap_slot;
+	size_t cnt;
+
 	lock_acquire(&swap_lock);
 
-	if(bitmap_test(swap_used_map, swap_index) == true)
+	if(bitmap_test(swap_used_map, slot) == false)
 		PANIC("Swapping in a free page.\n");
-	bitmap_flip(swap_used_map, swap_index);
+	in_cnt++;
 
-	int i;
-	for(i=0; i<SECTOR_PER_PAGE; i++)
+	if(slot >= ra_first && slot < ra_first + SWAP_READAHEAD
+		 && ra_valid[slot - ra_first])
+		memcpy(kpage, ra_buf + (slot - ra_first) * PGSIZE, PGSIZE);
+	else if(!zswap_load(slot, kpage))
 	{
-		void *cur_addr = addr + i*BLOCK_SECTOR_SIZE;
-		int cur_sector = swap_index*SECTOR_PER_PAGE + i;
-		block_read(swap_block, cur_sector, cur_addr);
+		/* Slots in the compressed cache hold nothing on disk. */
+		for(cnt = 1; spte->advice != MADV_RANDOM && cnt < SWAP_READAHEAD
+				 && same_process(slot + cnt) && !zswap_contains(slot + cnt); cnt++)
+			continue;
+		read_cnt += cnt;
+		if(cnt == 1)
+			block_read_multiple(swap_block, slot * SECTOR_PER_PAGE,
+													SECTOR_PER_PAGE, kpage);
+		else
+		{
+			block_read_multiple(swap_block, slot * SECTOR_PER_PAGE,
+													cnt * SECTOR_PER_PAGE, ra_buf);
+			memcpy(kpage, ra_buf, PGSIZE);
+			ra_first = slot;
+			memset(ra_valid, 0, sizeof ra_valid);
+			while(--cnt > 0)
+				ra_valid[cnt] = true;
+		}
 	}
-	
-	lock_acquire(&swap_lock);
+	slot_release(slot);
+
+	lock_release(&swap_lock);
 }
 
-/* Swap out a frame starting at addr and return the swap index
-	 where it is swap to. KERNEL PANIC if fail. */
-int swap_out(void *addr)
+/* Writes the CNT resident pages in SPTES, which belong to the
+	 processes in OWNERS, to swap, in as few contiguous runs as free
+	 space allows, and stores each one's slot in its entry.  Uses up
+	 a reservation from swap_reserve() for each page. */
+void swap_out(struct sup_page_table_entry **sptes, struct thread **owners,
+							size_t cnt)
 {
 	if(!swap_block || !swap_used_map)
 		PANIC("SWAP partition not initialized (or failed).\n");
 
 	lock_acquire(&swap_lock);
-	int swap_index = bitmap_scan_and_flip(swap_used_map, 0, 1, false);
+	ASSERT(swap_reserved >= cnt);
+	swap_reserved -= cnt;
+	out_cnt += cnt;
+	while(cnt > 0)
+	{
+		size_t run = cnt < SWAP_CLUSTER ? cnt : SWAP_CLUSTER;
+		size_t first, i;
 
-	if(swap_index == BITMAP_ERROR)
-		PANIC("SWAP partition full.\n");
+		while((first = slot_alloc(run)) == BITMAP_ERROR)
+		{
+			if(run == 1)
+				PANIC("SWAP partition full.\n");
+			run /= 2;
+		}
 
-	/* Copy block sectors starting from addr to swap_index*SECTOR_PER_PAGE */
+		for(i = 0; i < run; i++)
+		{
+			sptes[i]->swap_slot = first + i;
+			swap_owner[first + i] = sptes[i];
+			owners[i]->swap_cnt++;
+		}
+		write_run(sptes, run);
+		sptes += run;
+		owners += run;
+		cnt -= run;
+	}
+	lock_release(&swap_lock);
+}
+
+/* Releases swap slot SLOT, which holds a page of the current
+	 process, without reading it. */
+void swap_free(size_t slot)
+{
+	lock_acquire(&swap_lock);
+	slot_release(slot);
+	lock_release(&swap_lock);
+}
+
+/* Prints swap statistics. */
+void swap_print_stats(void)
+{
+	printf("Swap: %zu pages out, %zu pages in, "
+				 "%zu pages written to disk, %zu pages read from disk\n",
+				 out_cnt, in_cnt, write_cnt, read_cnt);
+}
+
+/* Writes the CNT pages in SPTES, which have been given a run of
+	 consecutive slots, to those slots: into the compressed cache
+	 if it takes them, otherwise to disk, in one transfer per run
+	 of pages it turned away. */
+static void write_run(struct sup_page_table_entry **sptes, size_t cnt)
+{
+	size_t i = 0;
+
+	while(i < cnt)
+	{
+		size_t j;
+
+		if(zswap_store(sptes[i]->swap_slot, sptes[i]->kpage))
+		{
+			i++;
+			continue;
+		}
+		for(j = i + 1; j < cnt && !zswap_store(sptes[j]->swap_slot,
+																					sptes[j]->kpage); j++)
+			continue;
 
-	int i;
-	for(i=0; i<SECTOR_PER_PAGE; i++)
+		write_cnt += j - i;
+		if(j - i == 1)
+			block_write_multiple(swap_block, sptes[i]->swap_slot * SECTOR_PER_PAGE,
+													 SECTOR_PER_PAGE, sptes[i]->kpage);
+		else
+		{
+			size_t k;
+
+			for(k = i; k < j; k++)
+				memcpy(cluster_buf + (k - i) * PGSIZE, sptes[k]->kpage, PGSIZE);
+			block_write_multiple(swap_block, sptes[i]->swap_slot * SECTOR_PER_PAGE,
+													 (j - i) * SECTOR_PER_PAGE, cluster_buf);
+		}
+
+		/* sptes[j], if any, went to the cache. */
+		i = j + 1;
+	}
+}
+
+/* Marks a run of CNT free slots used, searching next-fit from
+	 the swap hand, and returns the first, or BITMAP_ERROR if there
+	 is no such run. */
+static size_t slot_alloc(size_t cnt)
+{
+	size_t first = bitmap_scan_and_flip(swap_used_map, swap_hand, cnt, false);
+
+	if(first == BITMAP_ERROR && swap_hand > 0)
+		first = bitmap_scan_and_flip(swap_used_map, 0, cnt, false);
+	if(first != BITMAP_ERROR)
 	{
-		void *cur_addr = addr + i*BLOCK_SECTOR_SIZE;
-		int cur_sector = swap_index*SECTOR_PER_PAGE + i;
-		block_write(swap_block, cur_sector, cur_addr);
+		swap_used_cnt += cnt;
+		swap_hand = first + cnt < swap_slot_cnt ? first + cnt : 0;
 	}
-	lock_release(&swap_lock);
+	return first;
+}
+
+/* Frees SLOT, which holds a page of the current process, and
+	 forgets any read-ahead copy of it. */
+static void slot_release(size_t slot)
+{
+	ASSERT(bitmap_test(swap_used_map, slot));
+
+	bitmap_reset(swap_used_map, slot);
+	swap_used_cnt--;
+	thread_current()->swap_cnt--;
+	swap_owner[slot] = NULL;
+	zswap_invalidate(slot);
+	if(slot >= ra_first && slot < ra_first + SWAP_READAHEAD)
+		ra_valid[slot - ra_first] = false;
+}
+
+/* Returns true if SLOT holds a page of the current process. */
+static bool same_process(size_t slot)
+{
+	struct sup_page_table_entry *spte;
 
-	return swap_index;
-}
\ No newline at end of file
+	if(slot >= swap_slot_cnt)
+		return false;
+	spte = swap_owner[slot];
+	return spte != NULL && page_lookup(spte->upage) == spte;
+}
@@ -1,25 +1,27 @@
 #ifndef VM_SWAP_H
 #define VM_SWAP_H
 
-#include <bitmap.h>
-
+#include <stdbool.h>
+#include <stddef.h>
 #include "devices/block.h"
-#include "threads/synch.h"
 #include "threads/vaddr.h"
 
 #define SECTOR_PER_PAGE (PGSIZE / BLOCK_SECTOR_SIZE)
 
-struct lock swap_lock;
-
-struct block *swap_block;
+/* Most pages written to swap in one transfer. */
+#define SWAP_CLUSTER 8
 
-/* A bitmap to store available frame (NOT available sector).
-	 bitmap(i) = true -> frame i is used.
-	 bitmap(i) = false -> frame i is free. */
-struct bitmap *swap_used_map;
+struct sup_page_table_entry;
+struct thread;
 
 void swap_init(void);
-void swap_in(int swap_index, void *addr);
-int swap_out(void *addr);
-
-#endif /* vm/swap.h */
\ No newline at end of file
+bool swap_available(void);
+bool swap_reserve(void);
+void swap_unreserve(void);
+void swap_in(struct sup_page_table_entry *spte, void *kpage);
+void swap_out(struct sup_page_table_entry **sptes, struct thread **owners,
+							size_t cnt);
+void swap_free(size_t slot);
+void swap_print_stats(void);
+
+#endif /* vm/swap.h */
@@ -0,0 +1,267 @@
+#include "vm/zswap.h"
+#include <debug.h>
+#include <list.h>
+#include <round.h>
+#include <stdint.h>
+#include <string.h>
+#include "vm/frame.h"
+#include "vm/lz.h"
+#include "vm/swap.h"
+#include "devices/block.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/vaddr.h"
+
+/* Compressed swap cache.
+
+	 A page on its way to a swap slot is first compressed with
+	 lz_compress() and, if it shrinks enough, kept in memory
+	 instead of being written to the slot.  swap.c still allocates
+	 the slot, so the cache is keyed by slot number and an entry
+	 can always be moved to disk later.  When the cache is full,
+	 its oldest entries are written to their slots to make room.
+
+	 Compressed pages live in a slab of user pool pages, taken one
+	 at a time as the cache grows, up to zswap_percent percent of
+	 the pool, and given back as soon as they empty.  A page that
+	 finds no free frame for the slab below that share goes to disk
+	 as it would without the cache.  Each slab page holds objects
+	 of a single size class, a multiple of ZSWAP_UNIT bytes, and a
+	 compressed page takes one object of the smallest class that
+	 fits it.
+
+	 swap.c calls every function here with its lock held. */
+
+/* Object sizes are multiples of ZSWAP_UNIT, up to ZSWAP_MAX.
+	 Pages that don't compress to ZSWAP_MAX bytes go to disk. */
+#define ZSWAP_UNIT 128
+#define ZSWAP_MAX (PGSIZE * 3 / 4)
+#define ZSWAP_CLASSES (ZSWAP_MAX / ZSWAP_UNIT)
+
+/* Share of the user pool used for compressed pages.  Set with
+	 the -zswap kernel command line option. */
+unsigned zswap_percent = ZSWAP_PERCENT_DEFAULT;
+
+/* A page of the slab. */
+struct zpage
+{
+	uint8_t *base;										/* Kernel address of the page, if any. */
+	size_t class;											/* Size class, if USED > 0. */
+	uint32_t used_map;								/* Bit I set if object I is used. */
+	size_t used;											/* Number of used objects. */
+	struct list_elem elem;						/* `partial' or `spare'. */
+};
+
+/* A compressed page. */
+struct zswap_entry
+{
+	size_t slot;											/* Swap slot it belongs to. */
+	struct zpage *page;								/* Slab page holding it. */
+	unsigned obj;											/* Object index in PAGE. */
+	size_t size;											/* Compressed size in bytes. */
+	struct list_elem elem;						/* `lru'. */
+};
+
+static struct block *swap_block;
+static struct zswap_entry **entries;		/* Entry for each slot, or NULL. */
+
+static struct zpage *zpages;						/* Slab page descriptors. */
+static struct list spare;								/* Descriptors with no page. */
+static struct list partial[ZSWAP_CLASSES];	/* Pages with free objects. */
+static struct list lru;									/* Entries, oldest first. */
+
+static uint8_t *zbuf;										/* Compression buffer. */
+static uint8_t *wb_buf;									/* Writeback buffer. */
+
+static size_t obj_size(size_t class);
+static size_t obj_cnt(size_t class);
+static bool obj_alloc(size_t class, struct zpage **page, unsigned *obj);
+static void obj_free(struct zpage *page, unsigned obj);
+static void writeback(void);
+static void entry_free(struct zswap_entry *e);
+
+/* Sets up the compressed cache in front of SWAP_BLOCK, which has
+	 SLOT_CNT slots. */
+void zswap_init(struct block *swap_block_, size_t slot_cnt)
+{
+	size_t page_cnt = frame_count() * zswap_percent / 100;
+	size_t i;
+
+	swap_block = swap_block_;
+	list_init(&spare);
+	list_init(&lru);
+	for(i = 0; i < ZSWAP_CLASSES; i++)
+		list_init(&partial[i]);
+	if(page_cnt == 0)
+		return;
+
+	entries = calloc(slot_cnt, sizeof *entries);
+	zpages = calloc(page_cnt, sizeof *zpages);
+	zbuf = palloc_get_page(0);
+	wb_buf = palloc_get_page(0);
+	if(entries == NULL || zpages == NULL || zbuf == NULL || wb_buf == NULL)
+		PANIC("could not initialize compressed swap");
+
+	for(i = 0; i < page_cnt; i++)
+		list_push_back(&spare, &zpages[i].elem);
+}
+
+/* Compresses KPAGE and keeps it as the contents of SLOT, making
+	 room by writing older pages to disk if needed.  Returns false,
+	 leaving the caller to write KPAGE to SLOT itself, if the page
+	 doesn't compress well or the cache is disabled. */
+bool zswap_store(size_t slot, const void *kpage)
+{
+	struct zswap_entry *e;
+	struct zpage *page;
+	unsigned obj;
+	size_t size, class;
+
+	if(entries == NULL)
+		return false;
+	ASSERT(entries[slot] == NULL);
+
+	size = lz_compress(kpage, PGSIZE, zbuf, ZSWAP_MAX);
+	if(size == 0)
+		return false;
+	class = DIV_ROUND_UP(size, ZSWAP_UNIT) - 1;
+
+	while(!obj_alloc(class, &page, &obj))
+	{
+		/* Older pages make room only once the slab is at its full
+			 size; below it, there was no free frame to grow into. */
+		if(list_empty(&lru) || !list_empty(&spare))
+			return false;
+		writeback();
+	}
+
+	e = malloc(sizeof *e);
+	if(e == NULL)
+	{
+		obj_free(page, obj);
+		return false;
+	}
+	memcpy(page->base + obj * obj_size(class), zbuf, size);
+	e->slot = slot;
+	e->page = page;
+	e->obj = obj;
+	e->size = size;
+	list_push_back(&lru, &e->elem);
+	entries[slot] = e;
+	return true;
+}
+
+/* If SLOT's contents are in the cache, decompresses them into
+	 KPAGE and returns true.  Otherwise returns false. */
+bool zswap_load(size_t slot, void *kpage)
+{
+	struct zswap_entry *e;
+
+	if(entries == NULL || entries[slot] == NULL)
+		return false;
+	e = entries[slot];
+	if(!lz_decompress(e->page->base + e->obj * obj_size(e->page->class),
+										e->size, kpage, PGSIZE))
+		PANIC("corrupt compressed swap page");
+	return true;
+}
+
+/* Returns true if SLOT's contents are in the cache rather than
+	 on disk. */
+bool zswap_contains(size_t slot)
+{
+	return entries != NULL && entries[slot] != NULL;
+}
+
+/* Forgets any cached contents of SLOT, which is being freed. */
+void zswap_invalidate(size_t slot)
+{
+	if(entries != NULL && entries[slot] != NULL)
+		entry_free(entries[slot]);
+}
+
+/* Returns the size of objects of CLASS. */
+static size_t obj_size(size_t class)
+{
+	return (class + 1) * ZSWAP_UNIT;
+}
+
+/* Returns the number of objects of CLASS in a slab page. */
+static size_t obj_cnt(size_t class)
+{
+	return PGSIZE / obj_size(class);
+}
+
+/* Allocates an object of CLASS and stores its page and index in
+	 *PAGE and *OBJ, adding a page to the slab if needed.  Returns
+	 false if the slab is full and can't grow. */
+static bool obj_alloc(size_t class, struct zpage **page, unsigned *obj)
+{
+	struct zpage *p;
+	unsigned i;
+
+	if(!list_empty(&partial[class]))
+		p = list_entry(list_front(&partial[class]), struct zpage, elem);
+	else if(!list_empty(&spare))
+	{
+		p = list_entry(list_front(&spare), struct zpage, elem);
+		p->base = palloc_get_page(PAL_USER);
+		if(p->base == NULL)
+			return false;
+		list_pop_front(&spare);
+		p->class = class;
+		p->used_map = 0;
+		p->used = 0;
+		list_push_front(&partial[class], &p->elem);
+	}
+	else
+		return false;
+
+	for(i = 0; p->used_map & (1u << i); i++)
+		continue;
+	p->used_map |= 1u << i;
+	if(++p->used == obj_cnt(class))
+		list_remove(&p->elem);
+	*page = p;
+	*obj = i;
+	return true;
+}
+
+/* Frees object OBJ in slab page PAGE, giving the page back to
+	 the user pool if that empties it. */
+static void obj_free(struct zpage *page, unsigned obj)
+{
+	ASSERT(page->used_map & (1u << obj));
+
+	page->used_map &= ~(1u << obj);
+	if(page->used-- == obj_cnt(page->class))
+		list_push_front(&partial[page->class], &page->elem);
+	if(page->used == 0)
+	{
+		list_remove(&page->elem);
+		palloc_free_page(page->base);
+		page->base = NULL;
+		list_push_back(&spare, &page->elem);
+	}
+}
+
+/* Writes the oldest cached page to its slot on disk. */
+static void writeback(void)
+{
+	struct zswap_entry *e = list_entry(list_front(&lru),
+																		 struct zswap_entry, elem);
+
+	zswap_load(e->slot, wb_buf);
+	block_write_multiple(swap_block, e->slot * SECTOR_PER_PAGE,
+											 SECTOR_PER_PAGE, wb_buf);
+	entry_free(e);
+}
+
+/* Removes E from the cache and frees it. */
+static void entry_free(struct zswap_entry *e)
+{
+	entries[e->slot] = NULL;
+	list_remove(&e->elem);
+	obj_free(e->page, e->obj);
+	free(e);
+}
@@ -0,0 +1,20 @@
+#ifndef VM_ZSWAP_H
+#define VM_ZSWAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct block;
+
+/* Default and current share of the user pool, in percent, that
+	 compressed swapped pages may take. */
+#define ZSWAP_PERCENT_DEFAULT 20
+extern unsigned zswap_percent;
+
+void zswap_init(struct block *swap_block, size_t slot_cnt);
+bool zswap_store(size_t slot, const void *kpage);
+bool zswap_load(size_t slot, void *kpage);
+bool zswap_contains(size_t slot);
+void zswap_invalidate(size_t slot);
+
+#endif /* vm/zswap.h */